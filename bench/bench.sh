@@ -0,0 +1,71 @@
+#!/bin/sh
+# bench.sh -- ejecuta los benchmarks de bench/ y escribe los
+# resultados en formato TSV (una linea por benchmark, con
+# cabecera) en la salida estandar.
+# License: BSD
+#
+# Variables de entorno:
+#   HOC      interprete a medir (./hoc)
+#   PLUGINS  plugins a cargar (./plugin0.so)
+#   RUNS     numero de ejecuciones de cada benchmark (5)
+#   BENCHES  benchmarks a ejecutar (todos)
+#
+# Columnas:
+#   bench         nombre del benchmark (bench/<bench>.hoc)
+#   runs          numero de ejecuciones
+#   median_s      mediana del tiempo de reloj, en segundos
+#   min_s         minimo del tiempo de reloj, en segundos
+#   instructions  instrucciones de la maquina virtual (hoc -p)
+#   ips           instrucciones por segundo (sobre la mediana)
+#   maxrss_kb     pico de memoria residente, en KiB
+#   native_s      mediana de la version en C (bench/<bench>.c), o -
+#   ratio         median_s / native_s, o -
+
+HOC=${HOC:-./hoc}
+PLUGINS=${PLUGINS:-./plugin0.so}
+RUNS=${RUNS:-5}
+BENCHES=${BENCHES:-"fib intloop dmath bltin print compile"}
+RUNBENCH=${RUNBENCH:-./bench/runbench}
+
+tmp=$(mktemp -d "${TMPDIR:-/tmp}/hocbench.XXXXXX") || exit 1
+trap 'rm -rf "$tmp"' 0 1 2 3 15
+
+# los plugins se cargan de un directorio propio, con un
+# manifiesto propio, para no depender de la instalacion.
+mkdir "$tmp/plugins"
+for p in $PLUGINS; do
+    ln -s "$(cd "$(dirname "$p")" && pwd)/$(basename "$p")" "$tmp/plugins/"
+done
+HOC_PLUGINS_PATH=$tmp/plugins
+HOC_PLUGINS_CACHE=$tmp/plugins.manifest
+export HOC_PLUGINS_PATH HOC_PLUGINS_CACHE
+
+./bench/gencompile.sh > "$tmp/compile.hoc"
+
+printf "bench\truns\tmedian_s\tmin_s\tinstructions\tips\tmaxrss_kb\tnative_s\tratio\n"
+
+for b in $BENCHES; do
+    src=bench/$b.hoc
+    [ -f "$src" ] || src=$tmp/$b.hoc
+
+    # numero de instrucciones, de la cabecera del informe de -p
+    insts=$("$HOC" -p "$src" 2>/dev/null \
+        | sed -n 's/^.*PROFILE[^:]*: *\([0-9][0-9]*\) instructions.*$/\1/p')
+
+    set -- $("$RUNBENCH" "$RUNS" "$HOC" "$src") || exit 1
+    median=$1 min=$2 rss=$3
+
+    native=- ratio=-
+    if [ -x "bench/$b" ]; then
+        set -- $("$RUNBENCH" "$RUNS" "bench/$b") || exit 1
+        native=$1
+    fi
+
+    awk -v b="$b" -v runs="$RUNS" -v med="$median" -v min="$min" \
+        -v insts="${insts:-0}" -v rss="$rss" -v nat="$native" 'BEGIN {
+        ips   = med > 0 ? insts / med : 0
+        ratio = nat != "-" && nat > 0 ? sprintf("%.1f", med / nat) : "-"
+        printf "%s\t%d\t%s\t%s\t%d\t%.0f\t%d\t%s\t%s\n",
+            b, runs, med, min, insts, ips, rss, nat, ratio
+    }'
+done
@@ -0,0 +1,23 @@
+/* bltin.c -- version nativa del benchmark bltin.hoc.
+ * License: BSD
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+double bltin(int n)
+{
+    double s = 0.0;
+
+    for (int i = 1; i <= n; i++) {
+        double x = i / 1000.0;
+        s = s + sin(x) * sqrt(x) + atan2(x, 2.0) - exp(-x);
+    }
+    return s;
+} /* bltin */
+
+int main()
+{
+    printf("%.15g\n", bltin(1000000));
+    return 0;
+} /* main */
@@ -0,0 +1,33 @@
+/* dmath.c -- version nativa del benchmark dmath.hoc.
+ * License: BSD
+ */
+
+#include <stdio.h>
+
+int mandel(int size, int maxit)
+{
+    int count = 0;
+
+    for (int row = 0; row < size; row++) {
+        double ci = 2.0 * row / size - 1.0;
+        for (int col = 0; col < size; col++) {
+            double cr = 3.0 * col / size - 2.0,
+                   zr = 0.0, zi = 0.0;
+            int    it = 0;
+            while (it < maxit && zr * zr + zi * zi < 4.0) {
+                double t = zr * zr - zi * zi + cr;
+                zi = 2.0 * zr * zi + ci;
+                zr = t;
+                it++;
+            }
+            if (it == maxit) count++;
+        }
+    }
+    return count;
+} /* mandel */
+
+int main()
+{
+    printf("%d\n", mandel(300, 50));
+    return 0;
+} /* main */
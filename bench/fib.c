@@ -0,0 +1,17 @@
+/* fib.c -- version nativa del benchmark fib.hoc.
+ * License: BSD
+ */
+
+#include <stdio.h>
+
+int fib(int n)
+{
+    if (n < 2) return n;
+    return fib(n - 1) + fib(n - 2);
+} /* fib */
+
+int main()
+{
+    printf("%d\n", fib(27));
+    return 0;
+} /* main */
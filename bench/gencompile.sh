@@ -0,0 +1,21 @@
+#!/bin/sh
+# gencompile.sh -- genera el benchmark compile.hoc: muchas
+# funciones peque;as, para medir el coste de la compilacion
+# (analisis, generacion de codigo y tabla de simbolos) frente
+# al de la ejecucion.
+# License: BSD
+
+n=${1:-3000}
+
+awk -v n="$n" 'BEGIN {
+    print "/* compile.hoc -- generado por gencompile.sh, no editar */"
+    print "func double f0(double x) { return x; }"
+    for (i = 1; i <= n; i++) {
+        printf "func double f%d(double x) {\n", i
+        printf "    double y = x * 0.5 + %d.0;\n", i
+        printf "    if (y > 100.0) y = y - 100.0;\n"
+        printf "    return f%d(y * 0.01) + y * 0.001;\n", i - 1
+        printf "}\n"
+    }
+    printf "print f%d(1.0), \"\\n\";\n", n
+}'
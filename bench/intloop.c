@@ -0,0 +1,21 @@
+/* intloop.c -- version nativa del benchmark intloop.hoc.
+ * License: BSD
+ */
+
+#include <stdio.h>
+
+/* volatile, para que el compilador no calcule el bucle
+ * en tiempo de compilacion */
+volatile long n = 3000000L;
+
+int main()
+{
+    long i = 0L, s = 0L;
+
+    while (i < n) {
+        s = s + (i ^ (i >> 3L)) % 7L;
+        i = i + 1L;
+    }
+    printf("%liL\n", s);
+    return 0;
+} /* main */
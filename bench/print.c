@@ -0,0 +1,14 @@
+/* print.c -- version nativa del benchmark print.hoc.
+ * License: BSD
+ */
+
+#include <stdio.h>
+
+int main()
+{
+    /* hoc escribe en stdout sin buffer (ver main.c) */
+    setbuf(stdout, NULL);
+    for (int i = 0; i < 100000; i++)
+        printf("line %d %.15g\n", i, i / 7.0);
+    return 0;
+} /* main */
@@ -0,0 +1,89 @@
+/* runbench.c -- ejecuta un comando varias veces y mide el
+ * tiempo de reloj (mediana y minimo) y el pico de memoria
+ * residente (RSS) de las ejecuciones.
+ * License: BSD
+ *
+ * Uso: runbench <runs> <comando> [<arg> ...]
+ * La salida estandar del comando se descarta, y runbench
+ * escribe una linea con tres campos separados por tabuladores:
+ *
+ *   <mediana en s>  <minimo en s>  <pico RSS en KiB>
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1.0E9;
+} /* now */
+
+static int by_value(const void *a, const void *b)
+{
+    double x = *(const double *)a,
+           y = *(const double *)b;
+    return (x > y) - (x < y);
+} /* by_value */
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s runs command [arg ...]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    int runs = atoi(argv[1]);
+    if (runs < 1) runs = 1;
+
+    double *times  = calloc(runs, sizeof *times);
+    long    maxrss = 0;
+
+    for (int i = 0; i < runs; i++) {
+        double t0  = now();
+        pid_t  pid = fork();
+
+        if (pid < 0) {
+            perror("fork");
+            exit(EXIT_FAILURE);
+        }
+        if (pid == 0) { /* hijo */
+            int null = open("/dev/null", O_WRONLY);
+            if (null >= 0) dup2(null, 1);
+            execvp(argv[2], argv + 2);
+            fprintf(stderr, "%s: %s\n", argv[2], strerror(errno));
+            _exit(127);
+        }
+
+        int           status;
+        struct rusage ru;
+        if (wait4(pid, &status, 0, &ru) < 0) {
+            perror("wait4");
+            exit(EXIT_FAILURE);
+        }
+        times[i] = now() - t0;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "%s: failed (status 0x%x)\n",
+                    argv[2], status);
+            exit(EXIT_FAILURE);
+        }
+        if (ru.ru_maxrss > maxrss)
+            maxrss = ru.ru_maxrss;
+    }
+    qsort(times, runs, sizeof *times, by_value);
+
+    double median = runs % 2
+                  ? times[runs / 2]
+                  : (times[runs / 2 - 1] + times[runs / 2]) / 2.0;
+
+    printf("%.6f\t%.6f\t%ld\n", median, times[0], maxrss);
+    return EXIT_SUCCESS;
+} /* main */
@@ -0,0 +1,185 @@
+/* vmbench.c -- microbenchmark de la maquina virtual.
+ * License: BSD
+ *
+ * Se enlaza con los modulos de hoc (todos menos main.o) y
+ * genera directamente en prog[], con code_inst(), un bucle
+ * cuyo cuerpo repite una secuencia de instrucciones (una
+ * "familia"), sin pasar por el analizador ni por la E/S.  Para
+ * cada familia mide el tiempo de ejecucion y le resta el de un
+ * bucle vacio con el mismo numero de vueltas, obteniendo los
+ * ns por instruccion.  Sirve para comparar estrategias de
+ * despacho y opciones de compilacion.
+ *
+ * Uso: vmbench [ <instrucciones> [ <repeticiones> ] ]
+ * (por defecto 10^8 instrucciones por familia, 5 repeticiones)
+ *
+ * La salida es TSV, con una linea por familia:
+ *
+ *   family  insts  ns_min  ns_median
+ *
+ * donde ns_min y ns_median son los ns por instruccion de la
+ * mejor repeticion y de la mediana. */
+
+#include <limits.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "config.h"
+
+#include "cellP.h"
+#include "symbolP.h"
+#include "code.h"
+#include "hoc.h"
+#include "init.h"
+
+#define UNITS  100  /* repeticiones del cuerpo en cada vuelta */
+
+char *progname; /* lo usan los mensajes de error (main.c) */
+
+static Symbol F = { .name = "vmbench" }, /* la funcion con el bucle */
+              G = { .name = "empty"   }; /* para call/ret */
+
+/* FAMILIAS: cada una emite una unidad del cuerpo del bucle,
+ * y opcionalmente un prologo y un epilogo para que la pila
+ * quede como estaba. */
+
+static void u_noop(void)    { code_inst(INST_noop); }
+static void u_push(void)    { code_inst(INST_constpush_i, (Cell){ .itg = 1 });
+                              code_inst(INST_drop); }
+static void p_int(void)     { code_inst(INST_constpush_i, (Cell){ .itg = 0 }); }
+static void u_add_i(void)   { code_inst(INST_constpush_i, (Cell){ .itg = 1 });
+                              code_inst(INST_add_i); }
+static void p_dbl(void)     { code_inst(INST_constpush_d, (Cell){ .dbl = 0.0 }); }
+static void u_add_d(void)   { code_inst(INST_constpush_d, (Cell){ .dbl = 1.0 });
+                              code_inst(INST_add_d); }
+static void u_argeval(void) { code_inst(INST_argeval_d, 2, "x");
+                              code_inst(INST_add_d); }
+static void u_if_f(void)    { code_inst(INST_constpush_i, (Cell){ .itg = 1 });
+                              code_inst(INST_if_f_goto, progp + 1); }
+static void u_goto(void)    { code_inst(INST_Goto, progp + 1); }
+static void u_call(void)    { code_inst(INST_call, &G); }
+static void p_limit(void)   { code_inst(INST_constpush_i, (Cell){ .itg = INT_MAX }); }
+static void u_loop(void)    { code_inst(INST_argloop_inc_goto_i, progp + 4,
+                                        2, "x", (Cell){ .itg = 1 }); }
+static void e_drop(void)    { code_inst(INST_drop); }
+
+static const struct family {
+    const char *name;
+    int         n_inst;          /* instrucciones por unidad */
+    void      (*prologue)(void);
+    void      (*unit)(void);
+    void      (*epilogue)(void);
+} families[] = {
+    { "noop",               1, NULL,    u_noop,    NULL,   },
+    { "constpush_i+drop",   2, NULL,    u_push,    NULL,   },
+    { "add_i",              2, p_int,   u_add_i,   e_drop, },
+    { "add_d",              2, p_dbl,   u_add_d,   e_drop, },
+    { "argeval_d+add_d",    2, p_dbl,   u_argeval, e_drop, },
+    { "if_f_goto",          2, NULL,    u_if_f,    NULL,   },
+    { "Goto",               1, NULL,    u_goto,    NULL,   },
+    { "call+enter+leave",   3, NULL,    u_call,    NULL,   },
+    { "argloop_inc_goto_i", 1, p_limit, u_loop,    e_drop, },
+};
+
+/* genera el programa y devuelve el punto de entrada */
+static Cell *build(const struct family *fam, long iters)
+{
+    progp = progbase = prog;
+
+    /* G: proc empty() {} */
+    G.defn = progp;
+    code_inst(INST_enter, 0);
+    code_inst(INST_leave_ret, 0);
+    G.defn_end = progp;
+
+    /* F: proc vmbench(double x), con un contador en fp[-1] */
+    F.defn = progp;
+    code_inst(INST_enter, 1);
+    code_inst(INST_constpush_i, (Cell){ .itg = iters });
+    code_inst(INST_argassign_i, -1, "n");
+    code_inst(INST_drop);
+    if (fam && fam->prologue)
+        fam->prologue();
+
+    Cell *loop = progp;
+    for (int j = 0; fam && j < UNITS; j++)
+        fam->unit();
+    code_inst(INST_argeval_i, -1, "n");
+    code_inst(INST_constpush_i, (Cell){ .itg = 1 });
+    code_inst(INST_sub_i);
+    code_inst(INST_argassign_i, -1, "n");
+    Cell *exit_jump = code_inst(INST_if_f_goto, prog);
+    code_inst(INST_Goto, loop);
+    exit_jump->param = progp - prog;
+
+    if (fam && fam->epilogue)
+        fam->epilogue();
+    code_inst(INST_leave_ret, 1);
+    F.defn_end = progp;
+
+    /* nivel superior: vmbench(1.5) */
+    Cell *entry = progbase = progp;
+    code_inst(INST_constpush_d, (Cell){ .dbl = 1.5 });
+    code_inst(INST_call, &F);
+    code_inst(INST_STOP);
+
+    return entry;
+} /* build */
+
+static double run(Cell *entry)
+{
+    struct timespec t0, t1;
+
+    initexec();
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    execute(entry);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    return (t1.tv_sec - t0.tv_sec) * 1.0E9
+         + (t1.tv_nsec - t0.tv_nsec);
+} /* run */
+
+static int by_value(const void *a, const void *b)
+{
+    double x = *(const double *)a,
+           y = *(const double *)b;
+    return (x > y) - (x < y);
+} /* by_value */
+
+int main(int argc, char *argv[])
+{
+    progname = argv[0];
+
+    long total = argc > 1 ? atol(argv[1]) : 100000000L;
+    int  reps  = argc > 2 ? atoi(argv[2]) : 5;
+    if (reps < 1) reps = 1;
+
+    init();
+    if (setjmp(begin)) { /* execerror() */
+        fprintf(stderr, "%s: execution error\n", progname);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("family\tinsts\tns_min\tns_median\n");
+    for (size_t f = 0; f < sizeof families / sizeof families[0]; f++) {
+        const struct family *fam = families + f;
+        long   iters = total / (UNITS * fam->n_inst);
+        double ns[reps];
+
+        if (iters < 1) iters = 1;
+        long insts = iters * UNITS * fam->n_inst;
+
+        for (int r = 0; r < reps; r++) {
+            /* el bucle vacio se mide en cada repeticion, para
+             * que ambas medidas vean el mismo estado del sistema */
+            double base = run(build(NULL, iters));
+            ns[r] = (run(build(fam, iters)) - base) / insts;
+        }
+        qsort(ns, reps, sizeof ns[0], by_value);
+        printf("%s\t%ld\t%.3f\t%.3f\n",
+                fam->name, insts, ns[0], ns[reps / 2]);
+    }
+    return EXIT_SUCCESS;
+} /* main */
@@ -115,9 +115,9 @@ BINOP_EVAL(ne, _i, itg, itg, !=)
 BINOP_EVAL(ne, _l, itg, lng, !=)
 BINOP_EVAL(ne, _s, itg, sht, !=)
 
-BINOP_EVAL_EXP(_c, lng, chr, ^^, fast_pwr_l)
+BINOP_EVAL_EXP(_c, chr, chr, ^^, fast_pwr_l)
 BINOP_EVAL_EXP(_d, dbl, dbl, ^^, pow)
-BINOP_EVAL_EXP(_f, dbl, flt, ^^, pow)
-BINOP_EVAL_EXP(_i, lng, itg, ^^, fast_pwr_l)
+BINOP_EVAL_EXP(_f, flt, flt, ^^, pow)
+BINOP_EVAL_EXP(_i, itg, itg, ^^, fast_pwr_l)
 BINOP_EVAL_EXP(_l, lng, lng, ^^, fast_pwr_l)
-BINOP_EVAL_EXP(_s, lng, sht, ^^, fast_pwr_l)
+BINOP_EVAL_EXP(_s, sht, sht, ^^, fast_pwr_l)
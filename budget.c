@@ -0,0 +1,81 @@
+/* budget.c -- limites de instrucciones y de tiempo de cada
+ * ejecucion de la maquina virtual.
+ * License: BSD
+ *
+ * Pensado para ejecutar codigo ajeno (p.ej. un while (1); no
+ * debe colgar el proceso).  Los limites se aplican a cada
+ * llamada a execute(), es decir, a cada sentencia de nivel
+ * superior.  Leer el reloj en cada salto seria demasiado caro,
+ * asi que el tiempo solo se mira cada UQ_BUDGET_SLICE
+ * instrucciones.  Al agotarse un limite se produce un
+ * execerror(), que como cualquier otro abandona la sentencia y
+ * vuelve a begin. */
+
+#include <limits.h>
+#include <time.h>
+
+#include "config.h"
+
+#include "error.h"
+#include "budget.h"
+
+#ifndef   UQ_BUDGET_SLICE /* { */
+#warning  UQ_BUDGET_SLICE should be defined in config.mk
+#define   UQ_BUDGET_SLICE       (65536)
+#endif /* UQ_BUDGET_SLICE    } */
+
+unsigned long budget_next = ULONG_MAX;
+
+static unsigned long max_insts,     /* 0: sin limite */
+                     insts_limit;   /* exec_stats.insts limite */
+static long long     max_ns,        /* 0: sin limite */
+                     deadline_ns;
+
+static long long now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+} /* now_ns */
+
+void budget_set(unsigned long insts, double secs)
+{
+    max_insts = insts;
+    max_ns    = secs * 1.0E9;
+} /* budget_set */
+
+static void next_check(void)
+{
+    budget_next = max_ns
+        ? exec_stats.insts + UQ_BUDGET_SLICE
+        : ULONG_MAX;
+    if (max_insts && insts_limit < budget_next)
+        budget_next = insts_limit;
+} /* next_check */
+
+void budget_begin(void)
+{
+    if (max_insts == 0 && max_ns == 0) {
+        budget_next = ULONG_MAX;
+        return;
+    }
+
+    insts_limit = exec_stats.insts + max_insts;
+    if (max_ns)
+        deadline_ns = now_ns() + max_ns;
+    next_check();
+} /* budget_begin */
+
+void budget_check(void)
+{
+    if (max_insts && exec_stats.insts >= insts_limit) {
+        budget_next = ULONG_MAX;
+        execerror("instruction budget exhausted (%lu instructions)",
+                max_insts);
+    }
+    if (max_ns && now_ns() >= deadline_ns) {
+        budget_next = ULONG_MAX;
+        execerror("time limit exceeded (%.3f s)", max_ns / 1.0E9);
+    }
+    next_check();
+} /* budget_check */
@@ -0,0 +1,34 @@
+/* budget.h -- limites de instrucciones y de tiempo de cada
+ * ejecucion de la maquina virtual.
+ * License: BSD
+ */
+#ifndef BUDGET_H_c81a4e06_cf8f_11f0_95b1_0023ae68f329
+#define BUDGET_H_c81a4e06_cf8f_11f0_95b1_0023ae68f329
+
+#include "stats.h"
+
+/* valor de exec_stats.insts en el que hay que volver a
+ * comprobar los limites (ULONG_MAX si no hay ninguno) */
+extern unsigned long budget_next;
+
+/* fija los limites de cada ejecucion: numero maximo de
+ * instrucciones y segundos de reloj (0 es sin limite).  Es
+ * tambien la interfaz para quien empotre el interprete. */
+void budget_set(unsigned long max_insts, double max_secs);
+
+/* empieza a contar los limites (lo llama execute()) */
+void budget_begin(void);
+
+/* comprobacion lenta: lanza execerror() si se ha agotado
+ * alguno de los limites, y calcula el siguiente budget_next */
+void budget_check(void);
+
+/* solo se comprueba en los saltos hacia atras y en call, que
+ * es por donde pasa cualquier ejecucion que no termina.  Sin
+ * limites, el coste es una comparacion que nunca se cumple. */
+#define BUDGET_CHECK() do {                  \
+        if (exec_stats.insts >= budget_next) \
+            budget_check();                  \
+    } while (0) /* BUDGET_CHECK */
+
+#endif /* BUDGET_H_c81a4e06_cf8f_11f0_95b1_0023ae68f329 */
@@ -11,9 +11,14 @@
 #include "config.h"
 #include "colors.h"
 #include "dynarray.h"
+#include "error.h"
 #include "hoc.h"
+#include "intern.h"
 #include "scope.h"
 #include "symbolP.h"
+#include "cellP.h"
+#include "code.h"
+#include "types.h"
 
 #include "builtinsP.h"
 
@@ -26,16 +31,45 @@ static builtin *builtins;
 static size_t   builtins_len,
                 builtins_cap;
 
-int
-register_builtin(
-        const char     *name,
-        const Symbol   *type,
-        bltin_cb        function_ref,
-        bltin_const_cb  const_function_ref,
-        ...)
+/* plugin que se esta cargando (indice en la tabla de plugin_cache.c,
+ * -1 si no hay ninguno), y si la carga se hace porque el lexer ha
+ * encontrado un builtin stub (carga perezosa).  En este ultimo caso
+ * no podemos instalar simbolos nuevos, pues podriamos estar dentro
+ * de un ambito local. */
+static int      loading_plugin = -1;
+static bool     loading_lazy   = false;
+
+void
+builtins_set_loading_plugin(
+        int             plugin_id,
+        bool            lazy)
 {
-    va_list args;
+    loading_plugin = plugin_id;
+    loading_lazy   = lazy;
+} /* builtins_set_loading_plugin */
 
+size_t
+get_builtins_len(void)
+{
+    return builtins_len;
+} /* get_builtins_len */
+
+static builtin *
+find_stub(const char *name)
+{
+    name = intern(name);
+    for (builtin *b = builtins; b < builtins + builtins_len; ++b) {
+        if (b->sym->name == name && BUILTIN_IS_STUB(b))
+            return b;
+    }
+    return NULL;
+} /* find_stub */
+
+static builtin *
+new_builtin(
+        const char     *name,
+        const Symbol   *type)
+{
     DYNARRAY_GROW(
             builtins,
             builtin *,
@@ -53,43 +87,346 @@ register_builtin(
                 : BLTIN_PROC,
             type);
     bltin->sym->bltin_index = ret_val;
-    bltin->subr             = function_ref;
-    bltin->subr_eval        = const_function_ref;
+    bltin->subr             = NULL;
+    bltin->subr_eval        = NULL;
+    bltin->kind             = BLTIN_KIND_STACK;
+    bltin->plugin           = loading_plugin;
+    bltin->impure           = false;
 
-    va_start(args, const_function_ref);
+    start_scope();
+
+    return bltin;
+} /* new_builtin */
+
+static void
+add_param(
+        builtin        *bltin,
+        const char     *par_name,
+        const Symbol   *par_type)
+{
+    DYNARRAY_GROW(bltin->sym->argums,
+                  Symbol *,
+                  1,
+                  UQ_ARGUMS_INCRMNT);
+
+    Symbol *lpar = register_local_var(par_name, par_type);
+    assert(lpar != NULL);
+
+    bltin->sym->argums[bltin->sym->argums_len++] = lpar;
+    bltin->sym->size_args += par_type->t2i->size;
+} /* add_param */
+
+static void
+end_params(builtin *bltin)
+{
+    end_scope();
+
+    /* SECOND PASS TO ADJUST PARAMETER OFFSETS */
+    for (int i = 0; i < bltin->sym->argums_len; ++i) {
+        bltin->sym->argums[i]->offset += bltin->sym->size_args;
+    }
+
+    /* el resultado no tiene hueco reservado en la pila: el builtin
+     * lo mete en lugar de los argumentos, como leave_ret_val en
+     * las subrutinas */
+} /* end_params */
+
+static int
+register_builtin_v(
+        const char     *name,
+        const Symbol   *type,
+        bltin_cb        function_ref,
+        bltin_const_cb  const_function_ref,
+        va_list         args)
+{
+    builtin *bltin = find_stub(name);
+
+    if (bltin != NULL) {
+        /* el builtin ya fue registrado como stub a partir del
+         * manifiesto de plugins, solo tenemos que completarlo. */
+        if (bltin->sym->typref != type) {
+            warning("builtin " GREEN "%s" ANSI_END
+                    " changed its type, ignored",
+                    name);
+            return -1;
+        }
+        bltin->subr      = function_ref;
+        bltin->subr_eval = const_function_ref;
+        bltin->kind      = BLTIN_KIND_STACK;
+        return bltin - builtins;
+    }
+
+    if (loading_lazy) {
+        warning("builtin " GREEN "%s" ANSI_END
+                " not in plugin manifest, ignored",
+                name);
+        return -1;
+    }
+
+    bltin = new_builtin(name, type);
+    bltin->subr      = function_ref;
+    bltin->subr_eval = const_function_ref;
 
     const Symbol *par_type;
     const char   *par_name;
 
-    start_scope();
     while ((par_name = va_arg(args, const char *)) != NULL) {
         par_type     = va_arg(args, const Symbol *);
+        add_param(bltin, par_name, par_type);
+    }
+
+    end_params(bltin);
+
+    return bltin - builtins;
+} /* register_builtin_v */
+
+int
+register_builtin(
+        const char     *name,
+        const Symbol   *type,
+        bltin_cb        function_ref,
+        bltin_const_cb  const_function_ref,
+        ...)
+{
+    va_list args;
+
+    va_start(args, const_function_ref);
+    int ret_val = register_builtin_v(
+            name, type,
+            function_ref,
+            const_function_ref,
+            args);
+    va_end(args);
+
+    return ret_val;
+} /* register_builtin */
+
+int
+register_builtin_stub(
+        const char     *name,
+        const Symbol   *type,
+        bltin_kind      kind,
+        int             plugin_id,
+        int             n_params,
+        const char *const par_names[],
+        const Symbol *const par_types[])
+{
+    int      saved_plugin = loading_plugin;
 
-        DYNARRAY_GROW(bltin->sym->argums,
-                      Symbol *,
-                      1,
-                      UQ_ARGUMS_INCRMNT);
+    loading_plugin = plugin_id;
+    builtin *bltin = new_builtin(name, type);
+    loading_plugin = saved_plugin;
 
-        Symbol *lpar = register_local_var(par_name, par_type);
-        assert(lpar != NULL);
+    bltin->kind    = kind;
 
-        bltin->sym->argums[bltin->sym->argums_len++] = lpar;
-        bltin->sym->size_args += par_type->t2i->size;
+    for (int i = 0; i < n_params; ++i) {
+        add_param(bltin, par_names[i], par_types[i]);
     }
-    end_scope();
+    end_params(bltin);
 
-    /* SECOND PASS TO ADJUST PARAMETER OFFSETS */
-    for (int i = 0; i < bltin->sym->argums_len; ++i) {
-        bltin->sym->argums[i]->offset += bltin->sym->size_args;
+    return bltin - builtins;
+} /* register_builtin_stub */
+
+/* las siguientes dos funciones sirven de subr() para los
+ * builtins nativos, en caso de que se llamen a traves de la
+ * instruccion bltin (generica), sacando los parametros de la
+ * pila.  Normalmente no se usan, ya que code_bltin() genera
+ * las instrucciones bltin_dd y bltin_ddd para ellos. */
+static void
+native_d_d_subr(int id)
+{
+    const builtin *bltin = get_builtin_info(id);
+    Cell           x     = pop();
+    Cell           res   = { .dbl = bltin->native.d_d(x.dbl) };
+
+    push(res);
+} /* native_d_d_subr */
+
+static void
+native_d_dd_subr(int id)
+{
+    const builtin *bltin = get_builtin_info(id);
+    Cell           y     = pop(),
+                   x     = pop();
+    Cell           res   = { .dbl = bltin->native.d_dd(x.dbl, y.dbl) };
+
+    push(res);
+} /* native_d_dd_subr */
+
+int
+register_builtin_d_d(
+        const char     *name,
+        bltin_d_d_cb    function_ref,
+        bltin_const_cb  const_function_ref,
+        const char     *par_name)
+{
+    int ret_val = register_builtin(
+            name, Double,
+            native_d_d_subr,
+            const_function_ref,
+            par_name, Double,
+            NULL);
+
+    if (ret_val < 0)
+        return ret_val;
+
+    builtin *bltin    = builtins + ret_val;
+    bltin->kind       = BLTIN_KIND_D_D;
+    bltin->native.d_d = function_ref;
+
+    return ret_val;
+} /* register_builtin_d_d */
+
+int
+register_builtin_d_dd(
+        const char     *name,
+        bltin_d_dd_cb   function_ref,
+        bltin_const_cb  const_function_ref,
+        const char     *par1_name,
+        const char     *par2_name)
+{
+    int ret_val = register_builtin(
+            name, Double,
+            native_d_dd_subr,
+            const_function_ref,
+            par1_name, Double,
+            par2_name, Double,
+            NULL);
+
+    if (ret_val < 0)
+        return ret_val;
+
+    builtin *bltin     = builtins + ret_val;
+    bltin->kind        = BLTIN_KIND_D_DD;
+    bltin->native.d_dd = function_ref;
+
+    return ret_val;
+} /* register_builtin_d_dd */
+
+/* subr() de los builtins que se generan en linea (como una
+ * instruccion registrada por el plugin).  No se puede llamar a
+ * traves de la instruccion bltin, pues la instruccion necesita
+ * su propio pc. */
+static void
+inline_subr(int id)
+{
+    execerror("builtin " GREEN "%s" ANSI_END
+              " can only be compiled inline",
+              get_builtin_info(id)->sym->name);
+} /* inline_subr */
+
+int
+register_builtin_inline(
+        const char     *name,
+        const Symbol   *type,
+        int             inst,
+        ...)
+{
+    va_list args;
+
+    if (inst < INST_EXTENSION_BASE || inst >= instruction_table_len) {
+        warning("builtin " GREEN "%s" ANSI_END
+                ": invalid instruction code %d, ignored",
+                name, inst);
+        return -1;
     }
 
-    if (is_func) {
-        bltin->sym->ret_val_offset = bltin->sym->size_args;
+    va_start(args, inst);
+    int ret_val = register_builtin_v(
+            name, type,
+            inline_subr,
+            NULL,
+            args);
+    va_end(args);
+
+    if (ret_val < 0)
+        return ret_val;
+
+    builtin     *bltin = builtins + ret_val;
+    const instr *i     = instruction_table + inst;
+    int          push  = type != NULL
+                       ? type->t2i->size
+                       : 0;
+
+    if (i->stk_pop != bltin->sym->size_args || i->stk_push != push) {
+        warning("builtin " GREEN "%s" ANSI_END
+                ": instruction " GREEN "%s" ANSI_END
+                " stack effect (%d, %d) doesn't match "
+                "its signature (%d, %d), not inlined",
+                name, i->name, i->stk_pop, i->stk_push,
+                bltin->sym->size_args, push);
+        /* no se compila en linea: queda como un builtin generico,
+         * cuya subr() (inline_subr()) da error al llamarlo, pero
+         * no descuadra la pila. */
+        return -1;
     }
 
+    bltin->kind        = BLTIN_KIND_INLINE;
+    bltin->native.inst = inst;
+
     return ret_val;
+} /* register_builtin_inline */
 
-} /* register_builtin */
+Cell *
+code_bltin(const Symbol *sym)
+{
+    const builtin *bltin = get_builtin_info(sym->bltin_index);
+
+    switch (bltin->kind) {
+    case BLTIN_KIND_D_D:
+        return code_inst(INST_bltin_dd,  sym->bltin_index);
+    case BLTIN_KIND_D_DD:
+        return code_inst(INST_bltin_ddd, sym->bltin_index);
+    case BLTIN_KIND_INLINE:
+        return code_inst(bltin->native.inst, sym->bltin_index);
+    default:
+        return code_inst(INST_bltin,     sym->bltin_index);
+    }
+} /* code_bltin */
+
+int
+builtin_set_impure(int id)
+{
+    if (id >= 0)
+        builtins[id].impure = true;
+    return id;
+} /* builtin_set_impure */
+
+bool
+builtin_is_foldable(int id)
+{
+    const builtin *bltin = get_builtin_info(id);
+
+    if (bltin->impure || bltin->sym->typref == NULL)
+        return false;
+    return bltin->subr_eval != NULL
+        || (bltin->kind == BLTIN_KIND_INLINE
+            && instruction_table[bltin->native.inst].const_eval != NULL);
+} /* builtin_is_foldable */
+
+int
+builtin_inline_inst(long id)
+{
+    if (id < 0 || (size_t) id >= builtins_len
+            || builtins[id].kind != BLTIN_KIND_INLINE)
+        return -1;
+    return builtins[id].native.inst;
+} /* builtin_inline_inst */
+
+ConstExpr
+fold_builtin_func(
+        int                  id,
+        const ConstArglist  *args)
+{
+    const builtin *bltin = get_builtin_info(id);
+
+    assert(builtin_is_foldable(id));
+    if (bltin->subr_eval != NULL)
+        return bltin->subr_eval(id, args);
+
+    const instr *i = instruction_table + bltin->native.inst;
+    return i->const_eval(i, args);
+} /* fold_builtin_func */
 
 ConstExpr
 eval_const_builtin_func(
@@ -119,12 +456,12 @@ eval_const_builtin_func(
     /* LCU: Sun Nov  9 13:48:28 -05 2025
      * TODO: llamar a function builtin (evaluada, no programada) */
 
-    if (bltin->subr_eval == NULL) {
+    if (!builtin_is_foldable(id)) {
         execerror("builtin " GREEN "%s" ANSI_END " cannot be used in "
                   "a constant expression",
                   sym->name);
     }
-    ConstExpr ret_val = bltin->subr_eval(sym->bltin_index, args);
+    ConstExpr ret_val = fold_builtin_func(id, args);
     puts(ret_val.typ->t2i->printval(
                    ret_val.cel,
                    workbench,
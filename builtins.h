@@ -7,6 +7,8 @@
 #ifndef BUILTINS_H_f92b2754_a84c_11f0_a2b7_0023ae68f329
 #define BUILTINS_H_f92b2754_a84c_11f0_a2b7_0023ae68f329
 
+#include <stdbool.h>
+
 #include "instr.h"
 #include "symbol.h"
 #include "plugins.h"
@@ -16,6 +18,13 @@ typedef struct builtin_s builtin;
 
 typedef void      (*bltin_cb)(      int bltin_id);
 
+/* funciones nativas que se llaman directamente desde
+ * las instrucciones bltin_dd y bltin_ddd, sin pasar por
+ * la pila con pop()/push().  El puntero a la funcion se
+ * almacena en la celda siguiente a la instruccion. */
+typedef double    (*bltin_d_d_cb)(  double x);
+typedef double    (*bltin_d_dd_cb)( double x, double y);
+
 int
 register_builtin(
         const char     *name,
@@ -24,9 +33,75 @@ register_builtin(
         bltin_const_cb  const_function_ref,
         ...); /* ...parameter_name, parameter_type, ... */
 
+int
+register_builtin_d_d(                /* double name(double par_name) */
+        const char     *name,
+        bltin_d_d_cb    function_ref,
+        bltin_const_cb  const_function_ref,
+        const char     *par_name);
+
+int
+register_builtin_d_dd(               /* double name(double par1, double par2) */
+        const char     *name,
+        bltin_d_dd_cb   function_ref,
+        bltin_const_cb  const_function_ref,
+        const char     *par1_name,
+        const char     *par2_name);
+
+/* registra un builtin que se compila en linea, como la instruccion
+ * inst (devuelta por register_instruction()).  La instruccion
+ * recibe los parametros en la pila, en el orden en que se declaran,
+ * y debe dejar el resultado en ella.  Su callback prog recibe como
+ * unico argumento el indice del builtin.  Si la instruccion tiene
+ * const_eval, se usa para evaluar el builtin en expresiones
+ * constantes.  Si el efecto en la pila de inst no cuadra con los
+ * parametros y el tipo, devuelve -1 y el builtin no se compila
+ * en linea. */
+int
+register_builtin_inline(
+        const char     *name,
+        const Symbol   *type,
+        int             inst,
+        ...); /* ...parameter_name, parameter_type, ... */
+
+/* marca el builtin id (devuelto por alguna de las funciones
+ * register_builtin*()) como impuro: su resultado depende de algo
+ * mas que de sus parametros, o tiene efectos laterales (random,
+ * time, exit...), y nunca se evalua en tiempo de compilacion,
+ * aunque tenga callback constante.  Devuelve id. */
+int
+builtin_set_impure(
+        int             id);
+
+/* true si una llamada al builtin id con parametros constantes
+ * puede sustituirse por su valor al compilar: no es impuro y
+ * tiene subr_eval (o su instruccion en linea tiene const_eval). */
+bool
+builtin_is_foldable(
+        int             id);
+
+/* instruccion en la que se compila el builtin id (registrado con
+ * register_builtin_inline()), o -1 si id no es un builtin en
+ * linea (o no es un builtin). */
+int
+builtin_inline_inst(
+        long            id);
+
+Cell *
+code_bltin(                          /* genera la llamada al builtin */
+        const Symbol   *bltin);
+
 ConstExpr
 eval_const_builtin_func(
         int                  id,     /* builtin id to be called */
         const ConstArglist  *args);  /* arglist as an array (allocated with DYNARRAY_GROW) */
 
+/* como eval_const_builtin_func(), pero sin la traza, para plegar
+ * las llamadas de las expresiones normales.  El builtin debe
+ * cumplir builtin_is_foldable(). */
+ConstExpr
+fold_builtin_func(
+        int                  id,
+        const ConstArglist  *args);
+
 #endif /* BUILTINS_H_f92b2754_a84c_11f0_a2b7_0023ae68f329 */
@@ -8,16 +8,59 @@
 #ifndef BUILTINSP_H_650fa348_a85a_11f0_9d05_0023ae68f329
 #define BUILTINSP_H_650fa348_a85a_11f0_9d05_0023ae68f329
 
+#include <stdbool.h>
+
 #include "instr.h"
 
 #include "builtins.h"
 
+typedef enum bltin_kind_e {
+    BLTIN_KIND_STACK,  /* subr() saca los parametros de la pila */
+    BLTIN_KIND_D_D,    /* double f(double), llamada directa */
+    BLTIN_KIND_D_DD,   /* double f(double, double), llamada directa */
+    BLTIN_KIND_INLINE, /* instruccion registrada por un plugin */
+} bltin_kind;
+
 struct builtin_s {
     Symbol         *sym;
     bltin_cb        subr;
     bltin_const_cb  subr_eval;
+    bltin_kind      kind;
+    union {                 /* solo si kind != BLTIN_KIND_STACK */
+        bltin_d_d_cb    d_d;
+        bltin_d_dd_cb   d_dd;
+        int             inst;   /* BLTIN_KIND_INLINE */
+    }               native;
+    int             plugin; /* indice del plugin, -1 si ninguno */
+    bool            impure; /* nunca se evalua al compilar */
 }; /* struct builtin_s */
 
+/* un builtin registrado a partir del manifiesto de plugins
+ * (ver plugin_cache.c) no tiene aun subr, hasta que se carga
+ * el plugin. */
+#define BUILTIN_IS_STUB(_b) ((_b)->subr == NULL)
+
 const builtin *get_builtin_info(int id);
 
+size_t get_builtins_len(void);
+
+/* registra un builtin cuyo plugin todavia no esta cargado */
+int
+register_builtin_stub(
+        const char     *name,
+        const Symbol   *type,
+        bltin_kind      kind,
+        int             plugin_id,
+        int             n_params,
+        const char *const par_names[],
+        const Symbol *const par_types[]);
+
+/* los builtins registrados a partir de ahora pertenecen
+ * al plugin plugin_id.  Si lazy, solo se admiten aquellos
+ * que ya estan registrados como stubs. */
+void
+builtins_set_loading_plugin(
+        int             plugin_id,
+        bool            lazy);
+
 #endif /* BUILTINSP_H_650fa348_a85a_11f0_9d05_0023ae68f329 */
@@ -12,11 +12,22 @@
 #include "cell.h"
 #include "symbol.h"
 
+/* numero de bits del codigo de instruccion en una celda, y
+ * numero maximo de instrucciones (incluidas las de plugins) */
+#define CELL_INST_BITS         8
+#define CELL_MAX_INSTRUCTIONS  (1 << CELL_INST_BITS)
+
+/* el parametro (direccion de salto, de variable global o
+ * desplazamiento) ocupa el resto de los 64 bits de la celda,
+ * en lugar de 24, de forma que prog[] puede pasar de 2^23
+ * celdas. */
+#define CELL_PARAM_BITS        (64 - CELL_INST_BITS)
+
 /*  Celda de Memoria RAM donde se instala el programa  */
 union Cell_u {
     struct {
-        instr_code inst:   8;
-        int        param:  24;
+        instr_code inst:   CELL_INST_BITS;
+        long       param:  CELL_PARAM_BITS;
     };
     char         chr;
     short        sht;
@@ -27,8 +38,10 @@ union Cell_u {
     Cell        *cel;
     Symbol      *sym;
     const char  *str;
+    double     (*d_d)(double);          /* bltin_dd: llamada directa */
+    double     (*d_dd)(double, double); /* bltin_ddd: llamada directa */
 };
 
-extern Cell prog[];   /* memoria de programa */
+extern Cell *prog;    /* memoria de programa (ver progmem.c) */
 
 #endif /* CELLP_H_c5ba43da_ace0_11f0_8ed7_0023ae68f329 */
@@ -7,6 +7,7 @@
  */
 
 #include <assert.h>
+#include <limits.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -21,6 +22,14 @@
 #include "math.h"
 #include "types.h"
 #include "builtinsP.h"
+#include "profile.h"
+#include "sample.h"
+#include "stats.h"
+#include "lines.h"
+#include "stack.h"
+#include "progmem.h"
+#include "ring.h"
+#include "budget.h"
 
 #include "scope.h"
 
@@ -67,80 +76,74 @@
 #define PRG(_fmt, ...)
 #endif
 
-#ifndef  UQ_NPROG
-#warning UQ_NPROG debe definirse en config.mk
-#define  UQ_NPROG 10000 /* 65536 celdas para instrucciones/datos/pila */
-#endif
-
-Cell  prog[UQ_NPROG];  /* the machine memory */
-Cell *progp    = prog; /* next free cell for code generation */
-Cell *pc       = prog; /* program counter during execution */
+/* prog[] y los punteros a ella se inicializan en progmem_init() */
+Cell *progp    = NULL; /* next free cell for code generation */
+Cell *pc       = NULL; /* program counter during execution */
 Cell *fp       = NULL;
 Cell *sp       = NULL;
-Cell *progbase = prog; /* start of current subprogram */
-Cell *varbase  = prog + UQ_NPROG; /* pointer to last global allocated */
+Cell *progbase = NULL; /* start of current subprogram */
+Cell *varbase  = NULL; /* pointer to last global allocated */
+int   in_execute = 0;  /* pc es valido para los mensajes de error */
 
 void initcode(void)  /* initalize for code generation */
 {
     progp = progbase;
+    lines_truncate(progbase - prog); /* se regenera el nivel superior */
 } /* initcode */
 
 void initexec(void) /* initialize for code execution */
 {
+    stack_init(0); /* si main() no la ha creado ya (opcion -S) */
     fp    =
-    sp    = varbase;
+    sp    = stack_top;
 } /* initexec */
 
 
 
 int stacksize(void) /* return the stack size */
 {
-    return varbase - sp;
+    return stack_top - sp;
 } /* stacksize */
 
+/* push(), pop() y top() no comprueban los limites de la pila:
+ * las paginas de guarda que la rodean lo hacen por ellas (ver
+ * stack.c). */
 void push(Cell d)  /* push d onto stack */
 {
-    /*  Verificamos si el puntero apunta a una direccion mas alla
-        del final de la pila  */
-    if (sp <= progp)
-        execerror("stack overflow: "GREEN"progp=[%04lx], sp=[%04lx]",
-                progp - prog, sp - prog);
     *--sp = d;
 }
 
 Cell pop(void)    /* pops Datum and return top element from stack */
 {
-    if (sp >= varbase)
-        execerror("stack empty: sp=[%04lx], varbase[%04lx]",
-                sp, varbase);
     return *sp++;
 }
 
 Cell top(void)   /* returns the top of the stack */
 {
-    if (sp == varbase)
-        execerror("stack empty: sp=[%04lx], varbase[%04lx]",
-                sp, varbase);
     return *sp;
 }
 
 Cell *code_inst(instr_code ins, ...) /* install one instruction of operand */
 {
 
-    if ((ins < 0) || (ins >= instruction_set_len)) { /* invalid instruction */
+    if ((ins < 0) || (ins >= instruction_table_len)) { /* invalid instruction */
         execerror("invalid instruction code [%d]",
             ins);
     }
-    if (progp >= varbase) {
-        execerror("program too big (max=%d)",
-            UQ_NPROG);
-    }
+    const instr *i = instruction_table + ins;
 
-    const instr *i = instruction_set + ins;
+    if (progp + i->n_cells > progmem_code_end)
+        progmem_grow_code(progp + i->n_cells);
 
     PRG("[%04lx]: <%02x> %s",
             progp - prog, i->code_id, i->name);
 
+    /* anotamos la posicion del ultimo token leido (el analizador
+     * puede haber leido ya el siguiente, como lookahead) */
+    const token *tok = get_last_token(0);
+    if (tok != NULL)
+        lines_record(progp - prog, tok->lin, tok->col);
+
     progp->inst = ins; /* instalamos la instruccion */
 
     if (i->prog != NULL) { /* si hay mas */
@@ -165,11 +168,25 @@ void execute(Cell *p) /* run the machine */
             "sp=[%04lx], varbase=[%04lx], stacksize=%d" ANSI_END "\n",
             (p - prog), fp - prog,
             sp - prog, varbase - prog, stacksize());
+    if (sample_enabled)
+        sample_begin();
+    in_execute = 1;
+    RING_BEGIN();
+    budget_begin();
+    if (prof_enabled) { /* -p: bucle con contadores (ver profile.c) */
+        prof_execute(p);
+        in_execute = 0;
+        if (sample_enabled)
+            sample_end();
+        return;
+    }
     pc = p;
     const instr *instruction = NULL,
-                *STOP        = instruction_set + INST_STOP;
+                *STOP        = instruction_table + INST_STOP;
     do {
-        instruction = instruction_set + pc->inst;
+        instruction = instruction_table + pc->inst;
+        RING_RECORD(pc, sp);
+        exec_stats.insts++;
 
         EXEC("[%04lx]: <%02x> " CYAN "%s" ANSI_END,
                 pc - prog,
@@ -182,6 +199,9 @@ void execute(Cell *p) /* run the machine */
 #endif /* UQ_DEBUG_STACK    } */
         P_TAIL("\n");
     } while(instruction != STOP);
+    in_execute = 0;
+    if (sample_enabled)
+        sample_end();
     EXEC(BRIGHT YELLOW "END [%04lx], fp=[%04lx], "
             "sp=[%04lx], stacksize=%d" ANSI_END "\n",
             (pc - prog), fp - prog, sp - prog, stacksize());
@@ -382,6 +402,47 @@ OP_DIVI_MOD(mod, _s, sht,  %, FMT_SHORT)
 
 #undef OP  /* } */
 
+/* division y modulo por una constante, que pone la pasada
+ * strength (ver strength.c) en lugar de constpush y divi/mod
+ * cuando la constante no es cero, asi que no se comprueba.  Con
+ * las potencias de dos k = 2^n se usan desplazamientos y
+ * mascaras (divp2 lleva n y modp2 lleva k - 1), sumando k - 1 a
+ * los negativos para que redondeen hacia cero, como / y %. */
+#define SIGN_MASK(_x) ((_x) >> (sizeof (_x) * CHAR_BIT - 1)) /* -1 o 0 */
+
+#define OP_DIVK(_nam, _suff, _fld, _typ, _expr, _fmt) /* { */ \
+    void _nam##_suff(const instr *i)                \
+    {                                               \
+        _typ x   = pop()._fld,                      \
+             k   = pc[1]._fld;                      \
+        Cell res = { ._fld = (_expr) };             \
+                                                    \
+        P_TAIL(": " _fmt " %s " _fmt " -> " _fmt,   \
+                x, #_nam, k, res._fld);             \
+        push(res);                                  \
+                                                    \
+        UPDATE_PC();                                \
+    } /* _nam##_suff */                             \
+                                                    \
+    void _nam##_suff##_prt(                         \
+            const instr    *i,                      \
+            const Cell     *pc)                     \
+    {                                               \
+        PR(" " _fmt "\n", pc[1]._fld);              \
+    } /* _nam##_suff##_prt         }{ */
+
+OP_DIVK(divk,  _i, itg, int,  x / k, FMT_INT)
+OP_DIVK(divk,  _l, lng, long, x / k, FMT_LONG)
+OP_DIVK(modk,  _i, itg, int,  x % k, FMT_INT)
+OP_DIVK(modk,  _l, lng, long, x % k, FMT_LONG)
+OP_DIVK(divp2, _i, itg, int,  (x + (SIGN_MASK(x) & ((1  << k) - 1))) >> k, FMT_INT)
+OP_DIVK(divp2, _l, lng, long, (x + (SIGN_MASK(x) & ((1L << k) - 1))) >> k, FMT_LONG)
+OP_DIVK(modp2, _i, itg, int,  x - ((x + (SIGN_MASK(x) & k)) & ~k), FMT_INT)
+OP_DIVK(modp2, _l, lng, long, x - ((x + (SIGN_MASK(x) & k)) & ~k), FMT_LONG)
+
+#undef OP_DIVK   /* } */
+#undef SIGN_MASK
+
 #define RELOP(_nam, _suff, _fld, _op, _fmt) /* { */ \
     void _nam##_suff(const instr *i)                \
     {                                               \
@@ -594,21 +655,21 @@ void symb_prog(const instr *i, Cell *pc, va_list args)
     pc[0].param  = sym->defn - prog;
     pc[1].sym   = sym;
 
-    PRG(" "GREEN"%s"ANSI_END"[%04x]",
-        sym->name, pc[0].param);
+    PRG(" "GREEN"%s"ANSI_END"[%04lx]",
+        sym->name, (long) pc[0].param);
 }
 
 #define EVAL(_suff, _fld, _fmt) /* { */                \
     void eval##_suff(const instr *i)                   \
     {                                                  \
-        int     var_addr = pc[0].param;                \
+        long    var_addr = pc[0].param;                \
         Symbol *sym      = pc[1].sym;                  \
         Cell   *var      = prog + var_addr;            \
         Cell    tgt      = { ._fld = var->_fld };      \
                                                        \
         push(tgt);                                     \
                                                        \
-        P_TAIL(": "GREEN"%s"ANSI_END"[%04x] -> " _fmt, \
+        P_TAIL(": "GREEN"%s"ANSI_END"[%04lx] -> "_fmt, \
             sym->name, var_addr, tgt._fld);            \
                                                        \
         UPDATE_PC();                                   \
@@ -618,8 +679,8 @@ void symb_prog(const instr *i, Cell *pc, va_list args)
             const instr *i,                            \
             const Cell  *pc)                           \
     {                                                  \
-        PR(GREEN"%s"ANSI_END"[%04x]\n",                \
-            pc[1].sym->name, pc[0].param);             \
+        PR(GREEN"%s"ANSI_END"[%04lx]\n",               \
+            pc[1].sym->name, (long) pc[0].param);      \
     } /* eval##_suff##_prt               }{ */
 
 EVAL(_c, chr,  FMT_CHAR)   /* evaluates a global variable */
@@ -651,8 +712,9 @@ EVAL(_s, sht,  FMT_SHORT)
             const instr *i,              \
             const Cell  *pc)             \
     {                                    \
-        PR(GREEN"%s"ANSI_END"<%+d>\n",   \
-            pc[1].str, pc[0].param);     \
+        PR(GREEN"%s"ANSI_END"<%+ld>\n",  \
+            pc[1].str,                   \
+            (long) pc[0].param);         \
     } /* argeval##_suff##_prt         }{ */
 
 ARGEVAL(_c, chr, FMT_CHAR)   /* push local var onto stack */
@@ -667,7 +729,7 @@ ARGEVAL(_s, sht, FMT_SHORT)
 #define ASSIGN(_suff, _fld, _fmt) /* { */        \
     void assign##_suff(const instr *i)           \
     {                                            \
-        int     gvar_addr = pc[0].param;         \
+        long    gvar_addr = pc[0].param;         \
         Symbol *sym       = pc[1].sym;           \
         Cell   *var       = prog + gvar_addr;    \
         Cell    src       = top();               \
@@ -675,7 +737,7 @@ ARGEVAL(_s, sht, FMT_SHORT)
         *var = src;                              \
                                                  \
         P_TAIL(": " _fmt " -> "                  \
-                GREEN "%s" ANSI_END "[%04x]",    \
+                GREEN "%s" ANSI_END "[%04lx]",   \
                 src._fld, sym->name, gvar_addr); \
                                                  \
         UPDATE_PC();                             \
@@ -685,8 +747,9 @@ ARGEVAL(_s, sht, FMT_SHORT)
             const instr *i,                      \
             const Cell  *pc)                     \
     {                                            \
-        PR(GREEN "%s" ANSI_END "[%04x]\n",       \
-            pc[1].sym->name, pc[0].param);       \
+        PR(GREEN "%s" ANSI_END "[%04lx]\n",      \
+            pc[1].sym->name,                     \
+            (long) pc[0].param);                 \
     } /* assign##_suff##_prt         }{ */
 
 ASSIGN(_c, chr,  FMT_CHAR)      /* assign top value to next value */
@@ -703,7 +766,7 @@ void arg_str_prog(const instr *i, Cell *pc, va_list args)
 {
     pc[0].param = va_arg(args, int);
     pc[1].str  = va_arg(args, char *);
-    PRG(" "GREEN"%s"ANSI_END"<%+d>", pc[1].str, pc[0].param);
+    PRG(" "GREEN"%s"ANSI_END"<%+ld>", pc[1].str, (long) pc[0].param);
 }
 
 #define ARGASSIGN(_suff, _fld, _fmt) /* { */ \
@@ -729,8 +792,8 @@ void arg_str_prog(const instr *i, Cell *pc, va_list args)
             const instr *i,                  \
             const Cell  *pc)                 \
     {                                        \
-        PR(GREEN "%s" ANSI_END "<%+d>\n",    \
-            pc[1].str, pc[0].param);         \
+        PR(GREEN "%s" ANSI_END "<%+ld>\n",   \
+            pc[1].str, (long) pc[0].param);  \
     } /* argassign##_suff##_prt         }{ */
 
 ARGASSIGN(_c, chr,  FMT_CHAR)   /* store top of stack in local var */
@@ -775,6 +838,7 @@ void bltin(const instr *i)
     const Symbol  *func_desc = bltin->sym;
     Cell          *saved_fp  = fp; /* save fp to print arguments */
 
+    exec_stats.bltins++;
     fp = sp;
 
 #if UQ_CODE_DEBUG_EXEC /* { only if debug exec has been activated */
@@ -841,6 +905,62 @@ void bltin_prt(const instr *i, const Cell *pc)
     PR_TAIL(")\n");
 } /* bltin_prt */
 
+/* llamadas directas a funciones nativas de tipo
+ * double(*)(double) y double(*)(double, double).  El puntero
+ * a la funcion esta en pc[1], y los parametros se leen y el
+ * resultado se escribe directamente en la pila, sin pasar por
+ * get_builtin_info(), pop() ni push().  El numero de parametros
+ * se ha comprobado en tiempo de compilacion. */
+void bltin_dd(const instr *i)
+{
+    P_TAIL(" <%ld>: (" FMT_DOUBLE ")", (long) pc[0].param, sp[0].dbl);
+
+    exec_stats.bltins++;
+    sp[0].dbl = pc[1].d_d(sp[0].dbl);
+
+    P_TAIL(" -> " FMT_DOUBLE, sp[0].dbl);
+
+    UPDATE_PC();
+} /* bltin_dd */
+
+void bltin_ddd(const instr *i)
+{
+    P_TAIL(" <%ld>: (" FMT_DOUBLE ", " FMT_DOUBLE ")",
+        (long) pc[0].param, sp[1].dbl, sp[0].dbl);
+
+    exec_stats.bltins++;
+    sp[1].dbl = pc[1].d_dd(sp[1].dbl, sp[0].dbl);
+    sp++;
+
+    P_TAIL(" -> " FMT_DOUBLE, sp[0].dbl);
+
+    UPDATE_PC();
+} /* bltin_ddd */
+
+void bltin_dd_prt(const instr *i, const Cell *pc)
+{
+    bltin_prt(i, pc);
+} /* bltin_dd_prt */
+
+void bltin_ddd_prt(const instr *i, const Cell *pc)
+{
+    bltin_prt(i, pc);
+} /* bltin_ddd_prt */
+
+void bltin_native_prog(const instr *i, Cell *pc, va_list args)
+{
+    int            bltin_id = va_arg(args, int);
+    const builtin *bltin    = get_builtin_info(bltin_id);
+
+    pc[0].param = bltin_id;
+    switch (i->code_id) {
+    case INST_bltin_dd:  pc[1].d_d  = bltin->native.d_d;  break;
+    case INST_bltin_ddd: pc[1].d_dd = bltin->native.d_dd; break;
+    default: assert(!"invalid native builtin instruction");
+    }
+    PRG(" <%d> %s", bltin_id, bltin->sym->name);
+} /* bltin_native_prog */
+
 #define AND_THEN_OR_ELSE(_name, _fld, _op, _operation) /* { */\
     void _name(const instr *i)                                \
     {                                                         \
@@ -867,7 +987,7 @@ void bltin_prt(const instr *i, const Cell *pc)
             const instr *i,                                   \
             const Cell  *pc)                                  \
     {                                                         \
-        PR("[%04x]\n", pc[0].param);                          \
+        PR("[%04lx]\n", (long) pc[0].param);                  \
     } /* _name##_prt                       }{*/
 
 AND_THEN_OR_ELSE(and_then, itg,  ,  &&)
@@ -879,11 +999,13 @@ void call(const instr *i)   /* call a function */
 {
     Symbol *sym = pc[1].sym;
 
-    P_TAIL(": "GREEN"%s"ANSI_END"[%04x] -> ret_addr=[%04lx]",
-        sym->name, pc[0].param, pc + i->n_cells - prog);
+    P_TAIL(": "GREEN"%s"ANSI_END"[%04lx] -> ret_addr=[%04lx]",
+        sym->name, (long) pc[0].param, pc + i->n_cells - prog);
 
     Cell ret_addr = { .cel = pc + i->n_cells };
 
+    exec_stats.calls++;
+    BUDGET_CHECK();
     push(ret_addr);
 
     pc = prog + pc[0].param;
@@ -891,25 +1013,45 @@ void call(const instr *i)   /* call a function */
 
 void call_prt(const instr *i, const Cell *pc)
 {
-    PR(GREEN"%s"ANSI_END"[%04x], args=%ld\n",
+    PR(GREEN"%s"ANSI_END"[%04lx], args=%ld\n",
         pc[1].sym->name,
-        pc[0].param,
+        (long) pc[0].param,
         pc[1].sym->argums_len);
 }
 
-void ret(const instr *i) /* return from proc */
-{
-    Cell dest = pop();
-
-    P_TAIL(": -> [%04lx]", dest.cel - prog);
-
-    pc = dest.cel;
-}
-
-void ret_prt(const instr *i, const Cell *pc)
-{
-    PR("\n");
-}
+/* postambulo de una subrutina: deshace el enter (libera las
+ * locales y recupera el fp del llamante), retorna y saca los
+ * pc[0].param argumentos que habia metido el llamante.  Con
+ * leave_ret_val la funcion deja ademas su valor ({RET_VAL}, la
+ * primera local) en la pila, en lugar de los argumentos. */
+#define LEAVE_RET(_name, _has_val) /* { */                       \
+    void _name(const instr *i)                                  \
+    {                                                           \
+        Cell val = _has_val ? fp[-1] : (Cell){ 0 };             \
+                                                                \
+        sp = fp;                                                \
+        fp = pop().cel;                                         \
+        Cell dest = pop();                                      \
+        sp += pc[0].param;                                      \
+        if (_has_val)                                           \
+            push(val);                                          \
+                                                                \
+        exec_stats.rets++;                                      \
+        P_TAIL(": args=%ld -> [%04lx]",                         \
+                (long) pc[0].param, dest.cel - prog);           \
+                                                                \
+        pc = dest.cel;                                          \
+    } /* _name */                                               \
+                                                                \
+    void _name##_prt(const instr *i, const Cell *pc)            \
+    {                                                           \
+        PR("%ld\n", (long) pc[0].param);                        \
+    } /* _name##_prt                 }{ */
+
+LEAVE_RET(leave_ret,     false)
+LEAVE_RET(leave_ret_val, true)
+
+#undef LEAVE_RET /*                  } */
 
 Cell *getarg(int offset)    /* return a pointer to argument */
 {
@@ -919,7 +1061,7 @@ Cell *getarg(int offset)    /* return a pointer to argument */
 void arg_prog(const instr *i, Cell *pc, va_list args)
 {
     pc[0].param = va_arg(args, int);
-    PRG(" <%+d>", pc[0].param);
+    PRG(" <%+ld>", (long) pc[0].param);
 }
 
 void prstr(const instr *i) /* print string */
@@ -979,6 +1121,18 @@ void symbs_prt(const instr *i, const Cell *pc)
     PR("\n");
 }
 
+void stats(const instr *i)
+{
+    P_TAIL("\n");
+    stats_print();
+    UPDATE_PC();
+}
+
+void stats_prt(const instr *i, const Cell *pc)
+{
+    PR("\n");
+}
+
 void symbs_all(const instr *i)
 {
     P_TAIL("\n");
@@ -1006,19 +1160,25 @@ void brkpt_prt(const instr *i, const Cell *pc)
 void list(const instr *i)
 {
     const Cell *ip = prog;
+    int         last_lin = 0;
 
     P_TAIL("\n");
     while (ip->inst != INST_STOP) {
-        const instr *i = instruction_set + ip->inst;
+        const instr *i = instruction_table + ip->inst;
         if (ip == progbase) {
             printf("START:\n");
         }
+        int lin, col;
+        if (lines_lookup(ip - prog, &lin, &col) && lin != last_lin) {
+            printf("; linea %d\n", lin);
+            last_lin = lin;
+        }
         i->print(i, ip); /* LCU: Thu Apr 10 14:52:23 -05 2025
                           * Aqui es donde Edward desaparecio en el rio Orinoco. */
         ip += i->n_cells;
     }
 
-    const instr *stop = instruction_set + INST_STOP;
+    const instr *stop = instruction_table + INST_STOP;
     stop->print(stop, ip); /* STOP :) */
 
     UPDATE_PC();
@@ -1032,102 +1192,171 @@ void list_prt(const instr *i, const Cell *pc)
 void if_f_goto(const instr *i) /* jump if false */
 {
 
-    pc = pop().itg
-        ? pc + i->n_cells
-        : prog + pc[0].param;
+    if (pop().itg) {
+        pc += i->n_cells;
+    } else {
+        Cell *dest = prog + pc[0].param;
+        if (dest <= pc)
+            BUDGET_CHECK();
+        pc = dest;
+    }
 
     P_TAIL(": -> [%04lx]", pc - prog);
 }
 
 void if_f_goto_prt(const instr *i, const Cell *pc)
 {
-    PR("[%04x]\n", pc[0].param);
+    PR("[%04lx]\n", (long) pc[0].param);
 }
 
 void addr_prog(const instr *i, Cell *pc, va_list args)
 {
     progp[0].param = va_arg(args, Cell *) - prog;
 
-    PRG(" [%04x]", progp[0].param);
+    PRG(" [%04lx]", (long) progp[0].param);
 }
 
 void Goto(const instr *i) /* jump if false */
 {
-    P_TAIL(": -> [%04x]", pc[0].param);
-    pc = prog + pc[0].param;
+    P_TAIL(": -> [%04lx]", (long) pc[0].param);
+    Cell *dest = prog + pc[0].param;
+    if (dest <= pc)
+        BUDGET_CHECK();
+    pc = dest;
 }
 
 void Goto_prt(const instr *i, const Cell *pc)
 {
-    PR("[%04x]\n", pc[0].param);
+    PR("[%04lx]\n", (long) pc[0].param);
 }
 
-void noop(const instr *i)
+/* final de cada vuelta de un for (ver hoc.y): pc[0] salta al
+ * principio del cuerpo, pc[1] es la direccion del contador (o su
+ * desplazamiento respecto de fp), pc[2] su simbolo (o su nombre)
+ * y pc[3] el paso, constante y distinto de cero.  El limite esta
+ * en el top de la pila, donde se queda mientras dura el bucle.
+ * Se sale si el contador pasa del limite (por arriba con paso
+ * positivo, por abajo con negativo) o si la suma desborda. */
+void loop_symb_prog(const instr *i, Cell *pc, va_list args)
 {
-    UPDATE_PC();
-}
+    Cell   *dest = va_arg(args, Cell *);
+    Symbol *sym  = va_arg(args, Symbol *);
 
-void noop_prt(const instr *i, const Cell *pc)
-{
-    PR("\n");
+    pc[0].param = dest - prog;
+    pc[1].param = sym->defn - prog;
+    pc[2].sym   = sym;
+    pc[3]       = va_arg(args, Cell);
+
+    PRG(" "GREEN"%s"ANSI_END"[%04lx] [%04lx]",
+        sym->name, (long) pc[1].param, (long) pc[0].param);
 }
 
-void spadd(const instr *i) /* pop n elementos de la pila */
+void loop_arg_prog(const instr *i, Cell *pc, va_list args)
 {
-    int n = pc[0].param;
-    P_TAIL(": %+d", n);
-    sp += n;
+    Cell *dest = va_arg(args, Cell *);
 
-    UPDATE_PC();
-}
+    pc[0].param = dest - prog;
+    pc[1].param = va_arg(args, int);
+    pc[2].str   = va_arg(args, char *);
+    pc[3]       = va_arg(args, Cell);
 
-void spadd_prt(const instr *i, const Cell *pc)
-{
-    PR("%+d\n", pc[0].param);
+    PRG(" "GREEN"%s"ANSI_END"<%+ld> [%04lx]",
+        pc[2].str, (long) pc[1].param, (long) pc[0].param);
 }
 
-void push_fp(const instr *i)
-{
-    Cell dato = { .cel = fp };
-
-    P_TAIL(": fp=[%04lx] -> sp = %04lx", fp - prog, sp - prog);
-    push(dato);
+#define LOOP_INC_GOTO(_name, _fld, _typ, _var, _fmt, _vfmt, _vname) /* { */ \
+    void _name(const instr *i)                                  \
+    {                                                           \
+        Cell *var  = _var;                                      \
+        _typ  step = pc[3]._fld,                                \
+              lim  = top()._fld,                                \
+              val;                                              \
+        bool  more = !__builtin_add_overflow(var->_fld, step, &val) \
+                  && (step > 0 ? val <= lim : val >= lim);      \
+                                                                \
+        var->_fld = val;                                        \
+        P_TAIL(": " _fmt " -> [%04lx]", val,                    \
+            more ? (long) pc[0].param : pc + i->n_cells - prog); \
+                                                                \
+        if (more) {                                             \
+            BUDGET_CHECK();                                     \
+            pc = prog + pc[0].param;                            \
+        } else {                                                \
+            UPDATE_PC();                                        \
+        }                                                       \
+    } /* _name */                                               \
+                                                                \
+    void _name##_prt(const instr *i, const Cell *pc)            \
+    {                                                           \
+        PR(" " GREEN "%s" ANSI_END _vfmt " %+ld [%04lx]\n",   \
+            _vname, (long) pc[1].param, (long) pc[3]._fld,      \
+            (long) pc[0].param);                                \
+    } /* _name##_prt                 }{ */
+
+LOOP_INC_GOTO(loop_inc_goto_i,    itg, int,  prog + pc[1].param,
+              FMT_INT,  "[%04lx]", pc[2].sym->name)
+LOOP_INC_GOTO(loop_inc_goto_l,    lng, long, prog + pc[1].param,
+              FMT_LONG, "[%04lx]", pc[2].sym->name)
+LOOP_INC_GOTO(argloop_inc_goto_i, itg, int,  getarg(pc[1].param),
+              FMT_INT,  "<%+ld>",  pc[2].str)
+LOOP_INC_GOTO(argloop_inc_goto_l, lng, long, getarg(pc[1].param),
+              FMT_LONG, "<%+ld>",  pc[2].str)
+
+#undef LOOP_INC_GOTO /*              } */
 
+void noop(const instr *i)
+{
     UPDATE_PC();
 }
 
-void push_fp_prt(const instr *i, const Cell *pc)
+void noop_prt(const instr *i, const Cell *pc)
 {
     PR("\n");
 }
 
-void pop_fp(const instr *i)
+void spadd(const instr *i) /* pop n elementos de la pila */
 {
-    Cell dato = pop();
-
-    fp = dato.cel;
-    P_TAIL(": sp=%04lx -> FP=[%04lx]", sp - prog, fp - prog);
+    int n = pc[0].param;
+    P_TAIL(": %+d", n);
+    sp += n;
+    /* las variables locales pueden saltarse la pagina de guarda */
+    if (sp < stack_base)
+        execerror("stack overflow (%zu cells)", stack_cells());
+    if (stack_top - sp > exec_stats.max_depth)
+        exec_stats.max_depth = stack_top - sp;
 
     UPDATE_PC();
 }
 
-void pop_fp_prt(const instr *i, const Cell *pc)
+void spadd_prt(const instr *i, const Cell *pc)
 {
-    PR("\n");
+    PR("%+ld\n", (long) pc[0].param);
 }
 
-void move_sp_to_fp(const instr *i)
+/* preambulo de una subrutina: guarda el fp del llamante (encima
+ * de la direccion de retorno que ha metido call), apunta fp a el
+ * y reserva pc[0].param celdas de locales. */
+void enter(const instr *i)
 {
-    fp = sp;
+    int n = pc[0].param;
 
-    P_TAIL(": %04lx -> FP", fp - prog);
+    push((Cell){ .cel = fp });
+    fp  = sp;
+    sp -= n;
+    P_TAIL(": locals=%d -> FP=[%04lx]", n, fp - prog);
+
+    /* las variables locales pueden saltarse la pagina de guarda */
+    if (sp < stack_base)
+        execerror("stack overflow (%zu cells)", stack_cells());
+    if (stack_top - sp > exec_stats.max_depth)
+        exec_stats.max_depth = stack_top - sp;
 
     UPDATE_PC();
 }
 
-void move_sp_to_fp_prt(const instr *i, const Cell *pc)
+void enter_prt(const instr *i, const Cell *pc)
 {
-    PR("\n");
+    PR("%ld\n", (long) pc[0].param);
 }
 
 #define CHG_TYPE(_name, _from, _fmt_f, _to, _fmt_t) \
@@ -17,6 +17,10 @@
 extern Cell *progp;                     /* next free cell for code generation */
 extern Cell *progbase;                  /* pointer to first program instruction */
 extern Cell *varbase;                   /* pointer to last assigned variable */
+extern Cell *pc;                        /* program counter during execution */
+extern Cell *sp;                        /* stack pointer */
+extern Cell *fp;                        /* frame pointer */
+extern int   in_execute;                /* dentro de execute() */
 
 void    initcode(void);                 /* initalize for code generation */
 void    initexec(void);                 /* initalize for code execution */
@@ -39,7 +43,7 @@ Symbol *register_subr(                  /* put func/proc in symbol table */
         Cell         *entry_point);
 
 void    end_register_subr(              /* housekeeping after function definition */
-        const Symbol *subr);
+        Symbol       *subr);
 
 int     stacksize(void);                /* return the stack size */
 
@@ -54,12 +58,12 @@ Cell   *getarg(int arg);                /* return a pointer to argument */
  * Se invoca la macro una vez por cada instruccion, generandose
  * ambos prototipos (estos deben implementarse normalmente en la
  * unidad de compiladion code.c) */
-#define INST(_nom,_n, ...) \
-        void _nom(         \
-            const instr *);\
-        void _nom##_prt(   \
-            const instr *, \
-            const Cell *); \
+#define INST(_nom,_n,_stk, ...) \
+        void _nom(              \
+            const instr *);     \
+        void _nom##_prt(        \
+            const instr *,      \
+            const Cell *);      \
         __VA_ARGS__
 
 #define SUFF(_typ, _nom, _suf)  \
@@ -68,9 +72,12 @@ Cell   *getarg(int arg);                /* return a pointer to argument */
                 Cell        *,  \
                 va_list args);
 
+#define STK(_pop, _push)
+
 #include "instrucciones.h"
 
 #undef  INST
 #undef  SUFF
+#undef  STK
 
 #endif /* CODE_H_56139530_ac78_11f0_b0d7_0023ae68f329 */
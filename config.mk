@@ -34,6 +34,9 @@ vardir                   ?= $(exec_prefix)/var
 logdir                   ?= $(vardir)/log
 HOC_PLUGINS_PATH_VAR     ?= HOC_PLUGINS_PATH
 DEFAULT_HOC_PLUGINS_PATH ?= $(pkgactivepluginsdir)
+HOC_PLUGINS_CACHE_VAR    ?= HOC_PLUGINS_CACHE
+DEFAULT_HOC_PLUGINS_CACHE ?= .cache/$(PACKAGE)/plugins.manifest
+DEFAULT_HOC_TRACE_FILE   ?= $(PACKAGE).trace
 
 UQ_HOC_DEBUG             ?=  0
 UQ_HOC_TRACE_PATCHING    ?=  0
@@ -52,7 +55,7 @@ UQ_USE_INF               ?=  1
 UQ_USE_WRN               ?=  1
 UQ_USE_ERR               ?=  1
 UQ_USE_CRT               ?=  1
-UQ_NPROG                 ?= 0x800000
+UQ_NPROG                 ?= 0x40000000
 UQ_TAB_SIZE              ?= 4
 
 UQ_LAST_TOKENS_SZ               ?=  64
@@ -75,6 +78,30 @@ UQ_BRKPT_WIDTH2                 ?= -17
 UQ_SIZE_FP_RETADDR              ?=   2
 UQ_SUB_CALL_INCRMNT             ?=   8
 UQ_BUILTINS_INCRMNT             ?=  64
+UQ_PLUGINS_INCRMNT              ?=   8
+UQ_PLUGINS_MAX_PARAMS           ?=  16
+UQ_INSTR_EXT_INCRMNT            ?=   8
+UQ_PROF_INCRMNT                 ?=  32
+UQ_PROF_HOT_LINES               ?=  20
+UQ_SAMPLE_HZ                    ?= 997
+UQ_SAMPLE_MAX_DEPTH             ?= 128
+UQ_SAMPLE_SLOTS                 ?= 8192
+UQ_SAMPLE_STORE                 ?= 262144
+UQ_SAMPLE_INCRMNT               ?=  32
+UQ_TRACE_BUFSIZE                ?= 65536
+UQ_LINES_INCRMNT                ?= 1024
+UQ_LINES_CHECKPOINT             ?= 128
+UQ_STACK_SIZE                   ?= 1048576
+UQ_PROG_COMMIT                  ?= 65536
+UQ_PROG_HUGEPAGE_MIN            ?= 0
+UQ_RING_SIZE                    ?= 16
+UQ_BUDGET_SLICE                 ?= 65536
+UQ_IR_INCRMNT                   ?= 256
+UQ_LICM_MAX_TEMPS               ?= 16
+UQ_CSE_MAX_TEMPS                ?= 16
+UQ_INLINE_MAX_CELLS             ?= 32
+UQ_INLINE_MAX_SITES             ?= 64
+UQ_STRENGTH_MAX_EXP             ?= 8
 FMT_CHAR                        ?= 0x%02hhx
 FMT_DOUBLE                      ?= %#.15lg
 FMT_FLOAT                       ?= %#.7g
@@ -0,0 +1,175 @@
+/* cse.c -- pasada de la IR que elimina las subexpresiones comunes
+ * dentro de cada bloque basico.
+ * License: BSD
+ *
+ * En codigo sin saltos que lleguen a el, si una subexpresion
+ * pura aparece otra vez, identica, y entre medias no se asigna
+ * ninguna de las variables que lee (ni la modifica ninguna
+ * subrutina llamada, ver ir_clobber_range()), la segunda vez se
+ * puede leer el valor de la primera.  Este se guarda, sin
+ * sacarlo de la pila, en una local temporal nueva con argassign,
+ * y las apariciones siguientes se sustituyen por un argeval de
+ * ella.  No se usa dupl porque, en una maquina de pila, el valor
+ * solo esta en el top cuando las dos apariciones son
+ * consecutivas.
+ *
+ * Se empieza por las subexpresiones mas largas, que son las que
+ * mas ahorran, y solo se consideran las de tres o mas nodos: con
+ * menos, argassign mas argeval cuesta lo mismo que calcularla. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+
+#include "cellP.h"
+#include "code.h"
+#include "instr.h"
+#include "ir.h"
+#include "types.h"
+
+#ifndef   UQ_CSE_MAX_TEMPS /* { */
+#warning  UQ_CSE_MAX_TEMPS should be defined in config.mk
+#define   UQ_CSE_MAX_TEMPS      (16)
+#endif /* UQ_CSE_MAX_TEMPS    } */
+
+#define CSE_MIN_NODES   3
+
+/* nombre de las temporales en los listados */
+static const char tmp_name[] = "{CSE}";
+
+static bool same_node(const ir_node *a, const ir_node *b)
+{
+    const instr *i = instruction_table + a->op;
+
+    if (a->op != b->op || a->cel[0].param != b->cel[0].param)
+        return false;
+
+    /* en argeval, cel[1] es solo el nombre */
+    if (i->prog == arg_str_prog)
+        return true;
+    return memcmp(a->cel + 1, b->cel + 1,
+            (i->n_cells - 1) * sizeof a->cel[0]) == 0;
+} /* same_node */
+
+static bool same_expr(const ir_func *f, int s1, int s2, int len)
+{
+    for (int j = 0; j < len; j++)
+        if (!same_node(f->nodes + s1 + j, f->nodes + s2 + j))
+            return false;
+    return true;
+} /* same_expr */
+
+/* true si algo de (e1, s2) cambia lo que lee [s1, e1] */
+static bool clobbered(const ir_func *f, int s1, int e1, int s2)
+{
+    ir_clobber c   = { 0 };
+    bool       res = false;
+
+    ir_clobber_range(f, e1 + 1, s2, &c);
+    for (int j = s1; j <= e1 && !res; j++)
+        res = ir_clobbers(&c, f->nodes + j);
+    ir_clobber_free(&c);
+
+    return res;
+} /* clobbered */
+
+/* siguiente aparicion de [s1, s1 + len) desde el nodo from, en el
+ * mismo bloque basico, o -1 */
+static int next_match(
+        const ir_func *f,
+        const bool    *tgt,
+        int            s1,
+        int            len,
+        int            from)
+{
+    for (int s2 = from; s2 + len <= f->nodes_len; s2++) {
+        if (tgt[s2])
+            break;
+        if (same_expr(f, s1, s2, len)
+                && ir_expr_start(f, tgt, s2 + len - 1) == s2)
+        {
+            if (clobbered(f, s1, s1 + len - 1, s2))
+                break;
+            return s2;
+        }
+    }
+    return -1;
+} /* next_match */
+
+/* elimina la subexpresion comun mas larga de f, usando la local
+ * -slot.  Devuelve false si no hay ninguna. */
+static bool cse_one(ir_func *f, int slot)
+{
+    bool *tgt      = ir_jump_targets(f);
+    int   best_s   = -1,
+          best_len = CSE_MIN_NODES - 1;
+
+    for (int e1 = 0; e1 < f->nodes_len; e1++) {
+        int s1 = ir_expr_start(f, tgt, e1);
+
+        if (s1 < 0 || e1 - s1 + 1 <= best_len)
+            continue;
+
+        const type2inst *typ = ir_result_t2i(f->nodes + e1);
+        if (typ->argeval == NULL || typ->argassign == NULL)
+            continue;
+
+        if (next_match(f, tgt, s1, e1 - s1 + 1, e1 + 1) >= 0) {
+            best_s   = s1;
+            best_len = e1 - s1 + 1;
+        }
+    }
+
+    if (best_s < 0) {
+        free(tgt);
+        return false;
+    }
+
+    int              e1  = best_s + best_len - 1;
+    const type2inst *typ = ir_result_t2i(f->nodes + e1);
+
+    /* las siguientes apariciones leen la temporal... */
+    for (   int s2 = next_match(f, tgt, best_s, best_len, e1 + 1);
+            s2 >= 0;
+            s2 = next_match(f, tgt, best_s, best_len, s2 + best_len))
+    {
+        ir_node *n = f->nodes + s2;
+
+        *n = ir_make(typ->argeval->code_id, n->lin, n->col);
+        n->cel[0].param = -slot;
+        n->cel[1].str   = tmp_name;
+        for (int j = s2 + 1; j < s2 + best_len; j++)
+            ir_delete(f, j);
+    }
+
+    /* ... que guarda la primera, dejando el valor en la pila */
+    const ir_node *last = f->nodes + e1;
+    ir_node        as   = ir_make(typ->argassign->code_id,
+                                  last->lin, last->col);
+    as.cel[0].param = -slot;
+    as.cel[1].str   = tmp_name;
+    ir_insert(f, e1 + 1, &as);
+
+    free(tgt);
+    return true;
+} /* cse_one */
+
+bool ir_pass_cse(ir_func *f)
+{
+    int size  = ir_frame_size(f),
+        temps = 0;
+
+    if (size < 0)
+        return false;
+
+    while (temps < UQ_CSE_MAX_TEMPS && cse_one(f, size + temps + 1)) {
+        temps++;
+        ir_compact(f);
+    }
+    if (temps > 0)
+        ir_frame_reserve(f, size + temps);
+
+    return temps > 0;
+} /* ir_pass_cse */
@@ -0,0 +1,264 @@
+/* dce.c -- pasada de la IR que elimina el codigo muerto: el que
+ * no se alcanza y las asignaciones a locales que no se leen.
+ * License: BSD
+ *
+ * Se repite hasta que no cambia nada:
+ *
+ *   - los if_f_goto de una constante (if (0), while (1)...) pasan
+ *     a ser un Goto, o desaparecen, y los saltos al nodo siguiente
+ *     sobran, como un return justo antes de otro igual (el de la
+ *     salida).  Un Goto a otro Goto salta directamente al destino
+ *     de este.
+ *   - se borran los nodos a los que no se llega desde la entrada
+ *     (lo que sigue a un return, a un Goto o a un if de condicion
+ *     constante).  La salida (el leave_ret final o STOP) se
+ *     conserva siempre, para que f mantenga su forma (ver
+ *     ir_frame_size()), aunque no se llegue a ella.
+ *   - se borran las asignaciones a locales que no se leen en
+ *     ningun sitio, con la expresion asignada si es pura y no
+ *     puede fallar.  {RET_VAL} lo lee leave_ret_val.
+ *
+ * Los return ya son leave_ret cuando se optimiza (ver
+ * patch_returns() en hoc.y), y los saltos se reajustan en
+ * ir_compact().  Al final, si las ultimas locales del marco ya
+ * no se usan, se reduce la reserva del enter del preambulo. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+
+#include "cellP.h"
+#include "symbolP.h"
+#include "code.h"
+#include "instr.h"
+#include "ir.h"
+#include "types.h"
+
+/* saltos que se siguen para resolver un Goto a otro Goto (evita
+ * quedarse en un bucle de Gotos) */
+#define DCE_MAX_THREAD  16
+
+/* desplazamiento de la local o argumento que usa n, o 0 */
+static long arg_offset(const ir_node *n)
+{
+    int a = ir_arg_cell(n);
+
+    return a < 0 ? 0 : n->cel[a].param;
+} /* arg_offset */
+
+/* argassign a una local (argeval es puro, argassign no).  El
+ * argloop_inc_goto de un for tambien lee el contador. */
+static bool is_local_assign(const ir_node *n)
+{
+    return instruction_table[n->op].prog == arg_str_prog
+        && n->cel[0].param < 0 && ir_result_t2i(n) == NULL;
+} /* is_local_assign */
+
+static bool is_leave(instr_code op)
+{
+    return op == INST_leave_ret || op == INST_leave_ret_val;
+} /* is_leave */
+
+/* lo que lee leave_ret_val al retornar */
+static long ret_val_slot(const ir_func *f)
+{
+    return f->subr != NULL && f->subr->typref != NULL
+        ? f->subr->ret_val_offset
+        : 0;
+} /* ret_val_slot */
+
+static bool fold_jumps(ir_func *f)
+{
+    bool *tgt     = ir_jump_targets(f);
+    bool  changed = false;
+
+    for (int i = 0; i < f->nodes_len; i++) {
+        ir_node *n = f->nodes + i;
+
+        if (n->op == INST_if_f_goto && i > 0 && !tgt[i]
+                && f->nodes[i - 1].op == INST_constpush_i)
+        {
+            if (f->nodes[i - 1].cel[1].itg == 0) {
+                n->op = n->cel[0].inst = INST_Goto;
+            } else {
+                ir_delete(f, i);
+            }
+            ir_delete(f, i - 1);
+            changed = true;
+            continue;
+        }
+
+        if (n->op == INST_Goto) {
+            for (int k = 0; k < DCE_MAX_THREAD
+                    && n->target < f->nodes_len
+                    && n->target != i
+                    && f->nodes[n->target].op == INST_Goto
+                    && f->nodes[n->target].target != n->target; k++)
+            {
+                n->target = f->nodes[n->target].target;
+                changed   = true;
+            }
+        }
+
+        /* un return justo antes de la salida (o de otro igual)
+         * sobra: los saltos a el iran al siguiente */
+        if (is_leave(n->op) && i + 1 < f->nodes_len
+                && f->nodes[i + 1].op == n->op
+                && f->nodes[i + 1].cel[0].param == n->cel[0].param)
+        {
+            ir_delete(f, i);
+            changed = true;
+            continue;
+        }
+
+        if ((n->op == INST_Goto || n->op == INST_if_f_goto)
+                && n->target == i + 1)
+        {
+            if (n->op == INST_Goto) {
+                ir_delete(f, i);
+            } else {
+                ir_node dr = ir_make(INST_drop, n->lin, n->col);
+                *n = dr;
+            }
+            changed = true;
+        }
+    }
+    free(tgt);
+
+    return changed;
+} /* fold_jumps */
+
+static bool remove_unreachable(ir_func *f)
+{
+    int   len     = f->nodes_len,
+          exit    = len - 1,
+          n       = 0;
+    bool *seen    = calloc(len + 1, sizeof *seen),
+          changed = false;
+    int  *work    = malloc((2 * len + 2) * sizeof *work);
+
+    work[n++] = 0;
+    work[n++] = exit;
+    while (n > 0) {
+        int i = work[--n];
+
+        if (i < 0 || i >= len || seen[i])
+            continue;
+        seen[i] = true;
+
+        const ir_node *nd = f->nodes + i;
+        if (nd->target >= 0)
+            work[n++] = nd->target;
+        if (nd->op != INST_Goto && nd->op != INST_STOP
+                && !is_leave(nd->op))
+            work[n++] = i + 1;
+    }
+
+    for (int i = 0; i < len; i++) {
+        if (!seen[i] && !f->nodes[i].dead) {
+            ir_delete(f, i);
+            changed = true;
+        }
+    }
+    free(work);
+    free(seen);
+
+    return changed;
+} /* remove_unreachable */
+
+static bool remove_dead_stores(ir_func *f)
+{
+    bool changed = false;
+
+    /* brkpt y symbs_all muestran todas las locales */
+    for (int i = 0; i < f->nodes_len; i++)
+        if (f->nodes[i].op == INST_brkpt
+                || f->nodes[i].op == INST_symbs_all)
+            return false;
+
+    bool *tgt = ir_jump_targets(f);
+    for (int k = 0; k < f->nodes_len; k++) {
+        ir_node *as = f->nodes + k;
+
+        if (as->dead || !is_local_assign(as)
+                || as->cel[0].param == ret_val_slot(f))
+            continue;
+
+        bool read = false;
+        for (int j = 0; j < f->nodes_len && !read; j++) {
+            const ir_node *n = f->nodes + j;
+
+            read = !n->dead && !is_local_assign(n)
+                && arg_offset(n) == as->cel[0].param;
+        }
+        if (read)
+            continue;
+
+        /* "expr; argassign; drop": sobra todo si expr no tiene
+         * efectos */
+        int s = k + 1 < f->nodes_len && f->nodes[k + 1].op == INST_drop
+                && !tgt[k] && !tgt[k + 1]
+              ? ir_expr_start(f, tgt, k - 1)
+              : -1;
+        for (int j = s; s >= 0 && j < k; j++)
+            if (ir_may_fail(f->nodes + j))
+                s = -1;
+
+        if (s >= 0) {
+            for (int j = s; j <= k + 1; j++)
+                ir_delete(f, j);
+        } else {
+            ir_delete(f, k);
+        }
+        changed = true;
+    }
+    free(tgt);
+
+    return changed;
+} /* remove_dead_stores */
+
+/* reduce la reserva de locales del preambulo a las que se usan */
+static bool shrink_frame(ir_func *f)
+{
+    int used = -ret_val_slot(f);
+
+    if (f->subr == NULL)
+        return false;
+
+    for (int j = 0; j < f->nodes_len; j++)
+        if (-arg_offset(f->nodes + j) > used)
+            used = -arg_offset(f->nodes + j);
+
+    if (used >= f->frame_cells)
+        return false;
+
+    f->nodes[0].cel[0].param = f->frame_cells = used;
+
+    return true;
+} /* shrink_frame */
+
+bool ir_pass_dce(ir_func *f)
+{
+    bool changed = false,
+         round;
+
+    if (ir_frame_size(f) < 0)
+        return false;
+
+    do {
+        round  = fold_jumps(f);
+        ir_compact(f);
+        round |= remove_unreachable(f);
+        ir_compact(f);
+        round |= remove_dead_stores(f);
+        ir_compact(f);
+        changed |= round;
+    } while (round);
+
+    if (shrink_frame(f))
+        changed = true;
+
+    return changed;
+} /* ir_pass_dce */
@@ -98,6 +98,9 @@ void do_version(int cod)
     PS(logdir);
     PS(HOC_PLUGINS_PATH_VAR);
     PS(DEFAULT_HOC_PLUGINS_PATH);
+    PS(HOC_PLUGINS_CACHE_VAR);
+    PS(DEFAULT_HOC_PLUGINS_CACHE);
+    PS(DEFAULT_HOC_TRACE_FILE);
 
     P(UQ_HOC_DEBUG);
     P(UQ_HOC_TRACE_PATCHING);
@@ -139,6 +142,30 @@ void do_version(int cod)
     P(UQ_SIZE_FP_RETADDR);
     P(UQ_SUB_CALL_INCRMNT);
     P(UQ_BUILTINS_INCRMNT);
+    P(UQ_PLUGINS_INCRMNT);
+    P(UQ_PLUGINS_MAX_PARAMS);
+    P(UQ_INSTR_EXT_INCRMNT);
+    P(UQ_PROF_INCRMNT);
+    P(UQ_PROF_HOT_LINES);
+    P(UQ_SAMPLE_HZ);
+    P(UQ_SAMPLE_MAX_DEPTH);
+    P(UQ_SAMPLE_SLOTS);
+    P(UQ_SAMPLE_STORE);
+    P(UQ_SAMPLE_INCRMNT);
+    P(UQ_TRACE_BUFSIZE);
+    P(UQ_LINES_INCRMNT);
+    P(UQ_LINES_CHECKPOINT);
+    P(UQ_STACK_SIZE);
+    P(UQ_PROG_COMMIT);
+    P(UQ_PROG_HUGEPAGE_MIN);
+    P(UQ_RING_SIZE);
+    P(UQ_BUDGET_SLICE);
+    P(UQ_IR_INCRMNT);
+    P(UQ_LICM_MAX_TEMPS);
+    P(UQ_CSE_MAX_TEMPS);
+    P(UQ_INLINE_MAX_CELLS);
+    P(UQ_INLINE_MAX_SITES);
+    P(UQ_STRENGTH_MAX_EXP);
 
     PS(FMT_CHAR);
     PS(FMT_DOUBLE);
@@ -13,15 +13,32 @@
 #include "config.h"
 #include "colors.h"
 #include "hoc.h"
+#include "cellP.h"
+#include "code.h"
+#include "lines.h"
+#include "ring.h"
 #include "error.h"
 
 void execerror(const char *fmt, ...)
 {
     va_list args;
+    int     lin, col;
 
     va_start(args, fmt);
-    vwarning(fmt, args);
+    /* en ejecucion, la linea de lectura no es la del error: se
+     * busca la de la instruccion en curso (ver lines.c) */
+    if (in_execute && lines_lookup(pc - prog, &lin, &col)) {
+        printf(BRIGHT YELLOW "\n%s: " ANSI_END, progname);
+        vprintf(fmt, args);
+        printf(" " BRIGHT YELLOW "en la linea %d, columna %d" ANSI_END "\n",
+                lin, col);
+    } else {
+        vwarning(fmt, args);
+    }
     va_end(args);
+    if (in_execute)
+        ring_dump();
+    in_execute = 0;
     longjmp(begin, 0);
 } /* execerror */
 
@@ -8,6 +8,8 @@
 #ifndef ERROR_H_d929a99a_ace7_11f0_81ff_0023ae68f329
 #define ERROR_H_d929a99a_ace7_11f0_81ff_0023ae68f329
 
+#include <stdarg.h>
+
 void execerror(const char *fmt, ...);
 void warning(const char *fmt, ...);    /* print warning message */
 void vwarning(const char *fmt, va_list args);
@@ -54,6 +54,15 @@ typedef struct OpRel_s {
     token         tok;
 } OpRel;
 
+/* cabecera de un for (ver hoc.y), hasta el principio del cuerpo */
+typedef struct ForHead_s {
+    const Symbol *var;            /* contador */
+    Cell          step;           /* paso, del tipo del contador */
+    Cell         *test,           /* if_f_goto de la comprobacion de
+                                   * entrada, a parchear al final */
+                 *body;           /* primera instruccion del cuerpo */
+} ForHead;
+
 typedef struct ConstArglist_s {
     ConstExpr    *expr_list;
     size_t        expr_list_len,
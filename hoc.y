@@ -32,6 +32,8 @@
 #include "cellP.h"
 #include "scope.h"
 #include "builtins.h"
+#include "lines.h"
+#include "ir.h"
 
 void warning( const char *fmt, ...);
 void vwarning( const char *fmt, va_list args );
@@ -39,11 +41,16 @@ void yyerror( char * msg );
 
 static void patch_block(Cell*patch_point);
 static void add_patch_return(Symbol *subr, Cell *patch_point);
-static void patch_returns(const Symbol *subr, Cell *target);
-static OpRel code_unpatchedop(token op);
+static void patch_returns(const Symbol *subr);
+static Cell *code_leave(const Symbol *subr);
+static void reserve_ret_val(Symbol *subr);
+static void close_block(Cell *start);
+static void check_for_counter(const Symbol *var);
+static OpRel code_unpatched_op(token op);
+ConstExpr const_eval_op_bin(ConstExpr exp1, token op, ConstExpr exp2);
 static const Symbol *check_op_bin(const Expr *exp1, OpRel *op, const Expr *exp2);
 static bool code_conv_val(const Symbol *t_src, const Symbol *t_dst);
-static void patching_subr(const Symbol *subr, Cell *preamb, const char *what);
+static void patching_subr(Symbol *subr, Cell *preamb, const char *what);
 static ConstArglist const_arglist_add(
         ConstArglist  list,
         const Symbol *bltin,
@@ -53,6 +60,14 @@ const_conv_val(
         const Symbol *t_src,
         const Symbol *t_dst,
         Cell          orig);
+static bool expr_const(const Expr *exp, const Cell *end, ConstExpr *val);
+static Expr code_const(Cell *start, ConstExpr val);
+static void code_conv_expr(const Expr *exp, const Symbol *t_dst);
+static bool fold_op_bin(Expr *res, const Expr *exp1, const OpRel *op, const Expr *exp2);
+static bool fold_bltin(Expr *res, const Symbol *bltin, Cell *args);
+static ConstExpr const_neg(ConstExpr exp);
+static ConstExpr const_not(ConstExpr exp);
+static ConstExpr const_bit_not(ConstExpr exp);
 
 /*  Necersario para hacer setjmp y longjmp */
 jmp_buf begin;
@@ -199,6 +214,7 @@ size_t size_lvars = 0;
     ConstArglist  const_arglist; /* constant expression argument lists for builtins */
     token         tok;  /* tipo asociado a un operador, con todo el token */
     OpRel         opr;  /* tipo del operador relacional. */
+    ForHead       for_head; /* cabecera de un for */
 }
 
 %token        ERROR
@@ -214,7 +230,9 @@ size_t size_lvars = 0;
 %token <lit>  CHAR SHORT INTEGER LONG
 %token        RETURN
 %token <str>  STRING UNDEF
-%token        LIST
+%token        LIST STATS
+%token        INLINE
+%token        FOR TO STEP
 %token <sym>  TYPE
 %type  <cel>  stmt cond stmtlist
 %type  <expr> expr expr_or expr_and expr_bitor expr_bitand expr_bitxor expr_shift
@@ -233,6 +251,9 @@ size_t size_lvars = 0;
 %type  <const_expr> const_expr_shift const_expr_bitand const_expr_bitxor const_expr_bitor
 %type  <const_expr> const_expr_and const_expr
 %type  <const_arglist> const_arglist
+%type  <sym>  for_init
+%type  <const_expr> for_step
+%type  <for_head> for_head
 
 %%
 /*  Area de definicion de reglas gramaticales */
@@ -289,7 +310,7 @@ stmt
                              $$ = $2.cel;
                              /* asigno a la direccion de retorno de la funcion, en la
                               * cima de la lista de parametros */
-                             code_conv_val($2.typ, indef->typref);
+                             code_conv_expr(&$2, indef->typref);
                              CODE_INST_TYP(
                                        indef->typref,
                                        argassign,
@@ -307,6 +328,7 @@ stmt
     | SYMBS_ALL      ';'   { $$ = CODE_INST(symbs_all, get_current_symbol()); }
     | BRKPT          ';'   { $$ = CODE_INST(brkpt, get_current_symbol()); }
     | LIST           ';'   { $$ = CODE_INST(list); }
+    | STATS          ';'   { $$ = CODE_INST(stats); }
     | const_decl     ';'   { $$ = progp; }
     | WHILE cond do stmt   { $$ = $2;
                              CODE_INST(Goto, $2);
@@ -337,7 +359,7 @@ stmt
                                            "%d arguments, passed %d",
                                            $1->name, $1->argums_len, $4);
                              }
-                             CODE_INST(bltin, $1->bltin_index);
+                             code_bltin($1);
                              if ($1->type == BLTIN_FUNC) {
                                  CODE_INST(drop);
                              }
@@ -351,27 +373,108 @@ stmt
                                            "%d arguments, passed %d",
                                            $1->name, $1->argums_len, $4);
                              }
-                             CODE_INST(call, $1);             /* instruction */
-                             if ($1->size_args) {
-                                 CODE_INST(spadd, $1->size_args); /* pop arguments */
-                             }
+                             CODE_INST(call, $1);             /* instruction, leave_ret
+                                                               * saca los argumentos */
                              pop_sub_call_stack();
                            }
 
     | '{' create_scope stmtlist '}'  {
                              $$ = $2;
-                             scope *cs = get_current_scope();
-                             if (cs->base_offset + cs->size > size_lvars) {
-                                 size_lvars = cs->base_offset + cs->size;
-                                 PT("*** UPDATING size_lvars TO %zd\n", size_lvars);
+                             close_block($2);
+                           }
+
+    /* for (i = a to b step k) stmt queda como
+     *
+     *      i = a; drop
+     *      b                     el limite, en la pila hasta el final
+     *      dupl; eval i; swap; le (ge si k < 0)
+     *      if_f_goto fin
+     * cpo: stmt
+     *      loop_inc_goto i, k, cpo
+     * fin: drop
+     *
+     * de forma que cada vuelta es una sola instruccion, ademas del
+     * cuerpo.  El for tiene su propio ambito para que las locales
+     * de los bloques del cuerpo se reserven antes de meter el
+     * limite (ver close_block()). */
+    | FOR create_scope '(' for_head ')' stmt {
+                             const Symbol *var = $4.var,
+                                          *typ = var->typref;
+
+                             $$ = $2;
+                             if (var->type == LVAR) {
+                                 CODE_INST_TYP(typ, argloop_inc_goto, $4.body,
+                                               var->offset, var->name, $4.step);
+                             } else {
+                                 CODE_INST_TYP(typ, loop_inc_goto, $4.body,
+                                               var, $4.step);
+                             }
+                             BEGIN_PATCHING_CODE($4.test);
+                                 CODE_INST(if_f_goto, saved_progp);
+                             END_PATCHING_CODE();
+                             CODE_INST(drop);
+                             close_block($2);
+                           }
+    ;
+
+for_head
+    : for_init TO expr for_step {
+                             const Symbol *var = $1,
+                                          *typ = var->typref;
+
+                             if ($4.typ->t2i->flags & TYPE_IS_FLOATING_POINT) {
+                                 execerror("for step must be integral "
+                                           "(is %s)", $4.typ->name);
+                             }
+                             $$.var  = var;
+                             $$.step = const_conv_val($4.typ, typ, $4.cel);
+                             long step = typ == Integer ? $$.step.itg
+                                                        : $$.step.lng;
+                             if (step == 0) {
+                                 execerror("for step cannot be zero");
                              }
-                             if (get_root_scope() == cs) {
-                                 patch_block($2);
+
+                             code_conv_expr(&$3, typ); /* limite */
+                             CODE_INST(dupl);
+                             if (var->type == LVAR) {
+                                 CODE_INST_TYP(typ, argeval, var->offset,
+                                               var->name);
+                             } else {
+                                 CODE_INST_TYP(typ, eval, var);
+                             }
+                             CODE_INST(swap);
+                             if (step > 0) {
+                                 CODE_INST_TYP(typ, le);
+                             } else {
+                                 CODE_INST_TYP(typ, ge);
                              }
-                             end_scope();
+                             BEGIN_UNPATCHED_CODE();
+                                 $$.test = CODE_INST(if_f_goto, prog);
+                             END_UNPATCHED_CODE();
+                             $$.body = progp;
                            }
     ;
 
+for_init
+    : VAR  '=' expr        { check_for_counter($1);
+                             code_conv_expr(&$3, $1->typref);
+                             CODE_INST_TYP($1->typref, assign, $1);
+                             CODE_INST(drop);
+                             $$ = $1; }
+    | LVAR '=' expr        { check_for_counter($1);
+                             code_conv_expr(&$3, $1->typref);
+                             CODE_INST_TYP($1->typref, argassign,
+                                           $1->offset, $1->name);
+                             CODE_INST(drop);
+                             $$ = $1; }
+    ;
+
+for_step
+    : /* empty */          { $$.typ     = Integer;
+                             $$.cel.itg = 1; }
+    | STEP const_expr      { $$ = $2; }
+    ;
+
 builtin_proc
     : BLTIN_PROC           { push_sub_call_stack($1); }
     ;
@@ -626,9 +729,9 @@ stmtlist
 expr
     : VAR    '=' expr      {
 
-#define VAR_ASSIGN_EXPR(_exp_type, _var_type, ...) /* { */ \
+#define VAR_ASSIGN_EXPR(_exp, _var_type, ...) /* { */ \
         do {                                           \
-            code_conv_val(_exp_type, _var_type);       \
+            code_conv_expr(_exp, _var_type);           \
             CODE_INST_TYP(_var_type, ##__VA_ARGS__);   \
         } while (0) /* VAR_ASSIGN_EXPR                } */
 
@@ -636,7 +739,7 @@ expr
                              $$.typ = $1->typref;
 
                              VAR_ASSIGN_EXPR(
-                                     $3.typ,
+                                     &$3,
                                      $1->typref,
                                      assign,
                                      $1);
@@ -646,7 +749,7 @@ expr
                              $$.typ = $1->typref;
 
                              VAR_ASSIGN_EXPR(
-                                     $3.typ,
+                                     &$3,
                                      $1->typref,
                                      argassign,
                                      $1->offset,
@@ -673,11 +776,10 @@ expr
         do {                                                                    \
             const Symbol *var       = $1,                                       \
                          *var_type  = var->typref,                              \
-                         *exp_type  = $3.typ,                                   \
                          *res_type  = var_type;                                 \
             const token   op        = $2;                                       \
                                                                                 \
-            code_conv_val(exp_type, var_type); /* convert expr to var type */   \
+            code_conv_expr(&$3, var_type); /* convert expr to var type */       \
             CODE_INST_TYP(var_type, _eval, ##__VA_ARGS__); /* variable evaluation */ \
             CODE_INST(swap);                     /* swap them */                \
             switch (op.id) {                                                    \
@@ -898,13 +1000,14 @@ expr_bitor
                           $2.tok.lex,              \
                           right_type->name);       \
             }                                      \
-                                                   \
-            $$.cel = $1.cel;                       \
-            $$.typ = check_op_bin(&$1, &$2, &$3);  \
         } while (0)  /* BITOP    }  */
 
                               BITOP();
-                              CODE_INST_TYP($$.typ, bit_or);
+                              if (!fold_op_bin(&$$, &$1, &$2, &$3)) {
+                                  $$.cel = $1.cel;
+                                  $$.typ = check_op_bin(&$1, &$2, &$3);
+                                  CODE_INST_TYP($$.typ, bit_or);
+                              }
                             }
     | expr_bitxor
     ;
@@ -926,7 +1029,11 @@ const_expr_bitor
 expr_bitxor
     : expr_bitxor binop_bitxor expr_bitand {
                               BITOP();
-                              CODE_INST_TYP($$.typ, bit_xor);
+                              if (!fold_op_bin(&$$, &$1, &$2, &$3)) {
+                                  $$.cel = $1.cel;
+                                  $$.typ = check_op_bin(&$1, &$2, &$3);
+                                  CODE_INST_TYP($$.typ, bit_xor);
+                              }
                             }
     | expr_bitand
     ;
@@ -947,7 +1054,11 @@ binop_bitxor
 expr_bitand
     : expr_bitand binop_bitand expr_shift {
                               BITOP();
-                              CODE_INST_TYP($$.typ, bit_and);
+                              if (!fold_op_bin(&$$, &$1, &$2, &$3)) {
+                                  $$.cel = $1.cel;
+                                  $$.typ = check_op_bin(&$1, &$2, &$3);
+                                  CODE_INST_TYP($$.typ, bit_and);
+                              }
                             }
     | expr_shift
     ;
@@ -969,10 +1080,14 @@ binop_bitand
 expr_shift
     : expr_shift binop_shift expr_rel {
                               BITOP();
-                              switch ($2.tok.id) {
-                              case SHIFT_LEFT:   CODE_INST_TYP($$.typ, bit_shl); break;
-                              case SHIFT_RIGHT:  CODE_INST_TYP($$.typ, bit_shr); break;
-                              } /* switch */
+                              if (!fold_op_bin(&$$, &$1, &$2, &$3)) {
+                                  $$.cel = $1.cel;
+                                  $$.typ = check_op_bin(&$1, &$2, &$3);
+                                  switch ($2.tok.id) {
+                                  case SHIFT_LEFT:   CODE_INST_TYP($$.typ, bit_shl); break;
+                                  case SHIFT_RIGHT:  CODE_INST_TYP($$.typ, bit_shr); break;
+                                  } /* switch */
+                              }
                             }
     | expr_rel
     ;
@@ -998,17 +1113,19 @@ binop_shift
 
 expr_rel
     : expr_arit op_rel expr_arit {
-                              $$.typ = Integer;
-                              $$.cel = $1.cel;
-                              const Symbol *type = check_op_bin(&$1, &$2, &$3);
-                              switch ($2.tok.id) {
-                                  case '<':  CODE_INST_TYP(type, lt); break;
-                                  case '>':  CODE_INST_TYP(type, gt); break;
-                                  case  EQ:  CODE_INST_TYP(type, eq); break;
-                                  case  NE:  CODE_INST_TYP(type, ne); break;
-                                  case  GE:  CODE_INST_TYP(type, ge); break;
-                                  case  LE:  CODE_INST_TYP(type, le); break;
-                              } /* switch */
+                              if (!fold_op_bin(&$$, &$1, &$2, &$3)) {
+                                  $$.typ = Integer;
+                                  $$.cel = $1.cel;
+                                  const Symbol *type = check_op_bin(&$1, &$2, &$3);
+                                  switch ($2.tok.id) {
+                                      case '<':  CODE_INST_TYP(type, lt); break;
+                                      case '>':  CODE_INST_TYP(type, gt); break;
+                                      case  EQ:  CODE_INST_TYP(type, eq); break;
+                                      case  NE:  CODE_INST_TYP(type, ne); break;
+                                      case  GE:  CODE_INST_TYP(type, ge); break;
+                                      case  LE:  CODE_INST_TYP(type, le); break;
+                                  } /* switch */
+                              }
                             }
     | expr_arit
     ;
@@ -1049,11 +1166,13 @@ expr_arit
                                * $3 si $3 debe convertirse al tipo de $1 y parchear
                                * op_add si el que debe convertirse es $1 al tipo
                                * de $3 */
-                              $$.cel = $1.cel;
-                              $$.typ = check_op_bin(&$1, &$2, &$3);
-                              switch($2.tok.id) {
-                              case '+': CODE_INST_TYP($$.typ, add); break;
-                              case '-': CODE_INST_TYP($$.typ, sub); break;
+                              if (!fold_op_bin(&$$, &$1, &$2, &$3)) {
+                                  $$.cel = $1.cel;
+                                  $$.typ = check_op_bin(&$1, &$2, &$3);
+                                  switch($2.tok.id) {
+                                  case '+': CODE_INST_TYP($$.typ, add); break;
+                                  case '-': CODE_INST_TYP($$.typ, sub); break;
+                                  }
                               }
                             }
     | term
@@ -1083,12 +1202,15 @@ term
                               /* LCU: Mon Sep 15 12:36:54 -05 2025
                                * ver 9966c546_a5cf_11f0_b8f9_0023ae68f329,
                                * arriba. */
-                              $$.typ = check_op_bin(&$1, &$2, &$3);
-                              switch($2.tok.id) {
-                              case '*': CODE_INST_TYP($$.typ, mul);  break;
-                              case '/': CODE_INST_TYP($$.typ, divi); break;
-                              case '%': BITOP();
-                                        CODE_INST_TYP($$.typ, mod);  break;
+                              if ($2.tok.id == '%')
+                                  BITOP();
+                              if (!fold_op_bin(&$$, &$1, &$2, &$3)) {
+                                  $$.typ = check_op_bin(&$1, &$2, &$3);
+                                  switch($2.tok.id) {
+                                  case '*': CODE_INST_TYP($$.typ, mul);  break;
+                                  case '/': CODE_INST_TYP($$.typ, divi); break;
+                                  case '%': CODE_INST_TYP($$.typ, mod);  break;
+                                  }
                               }
                             }
     | fact
@@ -1117,8 +1239,10 @@ fact: prim op_exp fact      {
                               /* LCU: Mon Sep 15 12:36:54 -05 2025
                                * ver 9966c546_a5cf_11f0_b8f9_0023ae68f329,
                                * arriba. */
-                              $$.typ = check_op_bin(&$1, &$2, &$3);
-                              CODE_INST_TYP($$.typ, pwr);
+                              if (!fold_op_bin(&$$, &$1, &$2, &$3)) {
+                                  $$.typ = check_op_bin(&$1, &$2, &$3);
+                                  CODE_INST_TYP($$.typ, pwr);
+                              }
                             }
     | prim
     ;
@@ -1164,8 +1288,8 @@ prim: UNDEF                 { execerror("Symbol " BRIGHT GREEN "%s"
     | '(' TYPE ')' prim     { $$.cel = $4.cel;
                               $$.typ = $2; /* generamos el tipo del resultado y la
                                             * posicion de comienzo del codigo. */
-                              code_conv_val($4.typ, $2); /* Insercion del codigo
-                                                          * a ejecutar */
+                              code_conv_expr(&$4, $2); /* Insercion del codigo
+                                                        * a ejecutar */
                             }
     | '(' expr ')'          { $$ = $2; }
     | FLOAT                 { $$.cel = CODE_INST_TYP(Float,  constpush, $1);
@@ -1185,10 +1309,15 @@ prim: UNDEF                 { execerror("Symbol " BRIGHT GREEN "%s"
     | LVAR                  { $$.cel = CODE_INST_TYP($1->typref, argeval,
                                                      $1->offset, $1->name);
                               $$.typ = $1->typref; }
-    | '!' prim              { $$.cel = $2.cel;
-                              $$.typ = Integer;
-                              TOBOOL($2.typ);
-                              CODE_INST(not);
+    | '!' prim              { ConstExpr val;
+                              if (expr_const(&$2, progp, &val)) {
+                                  $$ = code_const($2.cel, const_not(val));
+                              } else {
+                                  $$.cel = $2.cel;
+                                  $$.typ = Integer;
+                                  TOBOOL($2.typ);
+                                  CODE_INST(not);
+                              }
                             }
     | '~' prim              { if ($2.typ->t2i->flags
                                       & TYPE_IS_FLOATING_POINT)
@@ -1197,13 +1326,24 @@ prim: UNDEF                 { execerror("Symbol " BRIGHT GREEN "%s"
                                             "operator %s, use a cast",
                                             $2.typ->name, $1.lex);
                               }
-                              $$.cel = $2.cel;
-                              $$.typ = $2.typ;
-                              CODE_INST_TYP($2.typ, bit_not);
+                              ConstExpr val;
+                              if (expr_const(&$2, progp, &val)) {
+                                  $$ = code_const($2.cel, const_bit_not(val));
+                              } else {
+                                  $$.cel = $2.cel;
+                                  $$.typ = $2.typ;
+                                  CODE_INST_TYP($2.typ, bit_not);
+                              }
                             }
     | '+' prim              { $$ = $2; }
-    | '-' prim              { $$ = $2;
-                              CODE_INST_TYP($2.typ, neg);  }
+    | '-' prim              { ConstExpr val;
+                              if (expr_const(&$2, progp, &val)) {
+                                  $$ = code_const($2.cel, const_neg(val));
+                              } else {
+                                  $$ = $2;
+                                  CODE_INST_TYP($2.typ, neg);
+                              }
+                            }
 
     | PLS_PLS VAR           {
 
@@ -1314,7 +1454,8 @@ prim: UNDEF                 { execerror("Symbol " BRIGHT GREEN "%s"
                                             "%d arguments, passed %d",
                                             $1->name, $1->argums_len, $4);
                               }
-                              CODE_INST(bltin, $1->bltin_index);
+                              if (!fold_bltin(&$$, $1, $2))
+                                  code_bltin($1);
                               pop_sub_call_stack();
                             }
 
@@ -1327,8 +1468,9 @@ prim: UNDEF                 { execerror("Symbol " BRIGHT GREEN "%s"
                                             "%d arguments, passed %d",
                                             $1->name, $1->argums_len, $4);
                               }
-                              CODE_INST(call,  $1);            /* instruction */
-                              CODE_INST(spadd, $1->size_args); /* eliminando argumentos */
+                              CODE_INST(call,  $1);            /* instruction, leave_ret_val
+                                                                * cambia los argumentos por
+                                                                * el resultado */
                               pop_sub_call_stack();
                             }
     ;
@@ -1350,57 +1492,10 @@ const_prim
                               $$.typ = Integer; }
     | LONG                  { $$.cel = $1;
                               $$.typ = Long; }
-    | '!' const_prim        { $$.typ = Integer;
-                              if        ($$.typ == Char) {
-                                  $$.cel.itg = ! $2.cel.chr;
-                              } else if ($$.typ == Short) {
-                                  $$.cel.itg = ! $2.cel.sht;
-                              } else if ($$.typ == Integer) {
-                                  $$.cel.itg = ! $2.cel.itg;
-                              } else if ($$.typ == Long) {
-                                  $$.cel.itg = ! $2.cel.lng;
-                              } else if ($$.typ == Float) {
-                                  $$.cel.itg = ! $2.cel.flt;
-                              } else if ($$.typ == Double) {
-                                  $$.cel.itg = ! $2.cel.dbl;
-                              } else {
-                                  execerror(GREEN "%s" ANSI_END " invalid",
-                                          $2.typ->name);
-                              }
-                            }
-    | '~' const_prim        { $$ = $2;
-                              if        ($$.typ == Char) {
-                                  $$.cel.chr = ~ $2.cel.chr;
-                              } else if ($$.typ == Short) {
-                                  $$.cel.sht = ~ $2.cel.sht;
-                              } else if ($$.typ == Integer) {
-                                  $$.cel.itg = ~ $2.cel.itg;
-                              } else if ($$.typ == Long) {
-                                  $$.cel.lng = ~ $2.cel.lng;
-                              } else {
-                                  execerror(GREEN "%s" ANSI_END " invalid",
-                                          $2.typ->name);
-                              }
-                            }
+    | '!' const_prim        { $$     = const_not($2); }
+    | '~' const_prim        { $$     = const_bit_not($2); }
     | '+' const_prim        { $$     = $2; }
-    | '-' const_prim        { $$     = $2;
-                              if        ($$.typ == Char) {
-                                  $$.cel.chr = - $2.cel.chr;
-                              } else if ($$.typ == Short) {
-                                  $$.cel.sht = - $2.cel.sht;
-                              } else if ($$.typ == Integer) {
-                                  $$.cel.itg = - $2.cel.itg;
-                              } else if ($$.typ == Long) {
-                                  $$.cel.lng = - $2.cel.lng;
-                              } else if ($$.typ == Float) {
-                                  $$.cel.flt = - $2.cel.flt;
-                              } else if ($$.typ == Double) {
-                                  $$.cel.dbl = - $2.cel.dbl;
-                              } else {
-                                  execerror(GREEN "%s" ANSI_END " invalid",
-                                          $2.typ->name);
-                              }
-                            }
+    | '-' const_prim        { $$     = const_neg($2); }
     | CONSTANT              { $$.typ = $1->typref;
                               $$.cel = $1->cel;
                             }
@@ -1435,11 +1530,7 @@ builtin_func
     ;
 
 function
-    : FUNCTION              { push_sub_call_stack($1);
-
-                              /* PUSH espacio para el valor a retornar */
-                              CODE_INST(spadd, -$1->typref->t2i->size);
-                            }
+    : FUNCTION              { push_sub_call_stack($1); }
     ;
 
 arglist_opt
@@ -1458,7 +1549,7 @@ arglist
                                             sub_call->argums_len,
                                             $$);
                               }
-                              code_conv_val($3.typ, sub_call->argums[$1]->typref);
+                              code_conv_expr(&$3, sub_call->argums[$1]->typref);
                             }
     | expr                  { $$ = 1;
                               Symbol *sub_call = top_sub_call_stack();
@@ -1468,7 +1559,7 @@ arglist
                                             " parameters",
                                             sub_call->name);
                               }
-                              code_conv_val($1.typ, sub_call->argums[0]->typref);
+                              code_conv_expr(&$1, sub_call->argums[0]->typref);
                             }
     ;
 
@@ -1484,14 +1575,11 @@ defn: proc_head '(' formal_arglist_opt ')' preamb block {
     ;
 
 preamb: /* empty */         {
-                              CODE_INST(push_fp);
-                              CODE_INST(move_sp_to_fp);
                               BEGIN_UNPATCHED_CODE();
-                                  /* LCU: Mon Sep  8 13:17:49 EEST 2025
-                                   * we need to return this pointer (not
-                                   * a pointer to the beginning of the code)
-                                   * because it is what we need to patch. */
-                                  $$ = CODE_INST(noop);
+                                  /* enter guarda fp y reserva las locales,
+                                   * cuyo numero no se sabe hasta el final
+                                   * (ver patch_block()). */
+                                  $$ = CODE_INST(enter, 0);
                               END_UNPATCHED_CODE();
                             }
     ;
@@ -1515,16 +1603,11 @@ formal_arglist_opt
                                         indef->argums[i]->name,
                                         indef->argums[i]->offset);
                               }
-                              if (indef->type == FUNCTION) {
-                                  indef->ret_val_offset = indef->size_args
-                                                        + UQ_SIZE_FP_RETADDR;
-                                  PT("+++ RET_VAL offset = %d\n",
-                                            indef->ret_val_offset);
-                              }
-                              get_current_scope()->size = 0;
+                              reserve_ret_val(indef);
                               $$ = indef->argums_len;
                             }
-    | /* empty */           { $$ = 0; }
+    | /* empty */           { reserve_ret_val(indef);
+                              $$ = 0; }
     ;
 
 formal_arglist
@@ -1562,6 +1645,8 @@ proc_head
                                         $2, progp - prog);
                               indef = $$;
                             }
+    | INLINE proc_head      { $$ = $2;
+                              $$->is_inline = 1; }
     ;
 
 func_head
@@ -1572,12 +1657,14 @@ func_head
                                 $3, progp - prog);
                               indef = $$;
                             }
+    | INLINE func_head      { $$ = $2;
+                              $$->is_inline = 1; }
     ;
 
 %%
 
 void patching_subr(
-        const Symbol *subr,
+        Symbol       *subr,
         Cell         *preamb,
         const char *what)
 {
@@ -1588,13 +1675,13 @@ void patching_subr(
       size_lvars = scope_size;
       PT("*** UPDATING size_lvars TO %zd\n", size_lvars);
     }
-    patch_returns(subr, progp); /* parcheamos todos los RETURN del
+    patch_returns(subr);        /* parcheamos todos los RETURN del
                                  * block */
-    patch_block(preamb);        /* parcheamos el spadd, 0 de preamb */
+    patch_block(preamb);        /* parcheamos el enter 0 de preamb */
 
     /* CODIGO A INSERTAR PARA TERMINAR (POSTAMBULO) */
-    CODE_INST(pop_fp);
-    CODE_INST(ret);
+    code_leave(subr);
+    ir_optimize(subr, subr->defn, progp); /* ver ir.c */
     end_scope();
     end_register_subr(subr);
     indef = NULL;
@@ -1748,6 +1835,232 @@ code_conv_val(
     return needs_to_change;
 } /* code_conv_val */
 
+/* Plegado de constantes.  Una expresion es constante si todo su
+ * codigo (desde exp->cel hasta end) es un unico constpush de su
+ * tipo: un literal, un simbolo CONSTANT o una subexpresion que
+ * ya se ha plegado.  No hace falta llevar un indicador en Expr,
+ * basta con mirar el codigo generado, y asi no hay que tocar
+ * todas las reglas que producen un Expr. */
+static bool expr_const(const Expr *exp, const Cell *end, ConstExpr *val)
+{
+    const instr *cp = exp->typ ? exp->typ->t2i->constpush : NULL;
+
+    if (cp == NULL
+            || exp->cel + cp->n_cells != end
+            || exp->cel->inst != cp->code_id)
+        return false;
+
+    val->typ = exp->typ;
+    val->cel = exp->cel[1];
+    return true;
+} /* expr_const */
+
+/* descarta el codigo generado desde start y lo sustituye por un
+ * constpush del valor val. */
+static Expr code_const(Cell *start, ConstExpr val)
+{
+    progp = start;
+    lines_truncate(start - prog); /* posiciones del codigo descartado */
+
+    Expr ret_val = {
+        .cel = CODE_INST_TYP(val.typ, constpush, val.cel),
+        .typ = val.typ,
+    };
+    return ret_val;
+} /* code_const */
+
+/* como code_conv_val(), pero si exp es constante, convierte el
+ * valor del constpush en lugar de generar la conversion. */
+static void code_conv_expr(const Expr *exp, const Symbol *t_dst)
+{
+    ConstExpr val;
+
+    if (exp->typ != t_dst && expr_const(exp, progp, &val)) {
+        BEGIN_PATCHING_CODE(exp->cel);
+            CODE_INST_TYP(t_dst, constpush,
+                    const_conv_val(val.typ, t_dst, val.cel));
+        END_PATCHING_CODE();
+    } else {
+        code_conv_val(exp->typ, t_dst);
+    }
+} /* code_conv_expr */
+
+/* true si const_eval_op_bin(exp1, op, exp2) terminaria con
+ * execerror(): no hay *_binop para el tipo de los operandos, o
+ * es una division o un modulo por cero (de cualquier tipo), o una
+ * potencia entera con exponente negativo o 0 ^^ 0 (ver
+ * fast_pwr_l()). */
+static bool const_op_bin_fails(ConstExpr exp1, token op, ConstExpr exp2)
+{
+    const Symbol *typ_res = exp1.typ->t2i->weight >= exp2.typ->t2i->weight
+                          ? exp1.typ
+                          : exp2.typ;
+    const type2inst *t2i = typ_res->t2i;
+    operator_cb      binop;
+
+    switch (op.id) {
+    case OR:          binop = t2i->or_binop;     break;
+    case AND:         binop = t2i->and_binop;    break;
+    case '|':         binop = t2i->bitor_binop;  break;
+    case '^':         binop = t2i->bitxor_binop; break;
+    case '&':         binop = t2i->bitand_binop; break;
+    case SHIFT_LEFT:  binop = t2i->shl_binop;    break;
+    case SHIFT_RIGHT: binop = t2i->shr_binop;    break;
+    case '<':         binop = t2i->lt_binop;     break;
+    case '>':         binop = t2i->gt_binop;     break;
+    case EQ:          binop = t2i->eq_binop;     break;
+    case GE:          binop = t2i->ge_binop;     break;
+    case LE:          binop = t2i->le_binop;     break;
+    case NE:          binop = t2i->ne_binop;     break;
+    case '+':         binop = t2i->plus_binop;   break;
+    case '-':         binop = t2i->minus_binop;  break;
+    case '*':         binop = t2i->mult_binop;   break;
+    case '/':         binop = t2i->divi_binop;   break;
+    case '%':         binop = t2i->mod_binop;    break;
+    case EXP:         binop = t2i->exp_binop;    break;
+    default:          return true;
+    } /* switch */
+
+    if (binop == NULL)
+        return true;
+
+    /* el divisor, convertido al tipo de la operacion: divi_d y
+     * divi_f tambien dan "Division por 0" */
+    Cell y = const_conv_val(exp2.typ, typ_res, exp2.cel);
+
+    if (op.id == '/' || op.id == '%')
+        return const_conv_val(typ_res, Double, y).dbl == 0.0;
+
+    if (op.id != EXP || !(t2i->flags & TYPE_IS_INTEGER))
+        return false;
+
+    int  e = const_conv_val(typ_res, Long, y).lng;
+    long x = const_conv_val(typ_res, Long,
+                    const_conv_val(exp1.typ, typ_res, exp1.cel)).lng;
+
+    return e < 0 || (x == 0 && e == 0);
+} /* const_op_bin_fails */
+
+/* si los dos operandos son constantes, evalua la operacion en
+ * tiempo de compilacion (con los *_binop de type2inst) y deja en
+ * *res un unico constpush con el resultado.  Nunca falla al
+ * compilar: lo que daria error (ver const_op_bin_fails()) no se
+ * pliega, para que falle en tiempo de ejecucion, que es donde
+ * debe fallar. */
+static bool fold_op_bin(Expr *res, const Expr *exp1, const OpRel *op, const Expr *exp2)
+{
+    ConstExpr val1, val2;
+
+    if (!expr_const(exp1, op->start, &val1)
+            || !expr_const(exp2, progp, &val2)
+            || const_op_bin_fails(val1, op->tok, val2))
+        return false;
+
+    *res = code_const(exp1->cel, const_eval_op_bin(val1, op->tok, val2));
+    return true;
+} /* fold_op_bin */
+
+/* si todos los argumentos de la llamada al builtin (cuyo codigo
+ * empieza en args) son constantes, y el builtin es puro y tiene
+ * callback constante, se evalua la llamada al compilar y se deja
+ * en *res un unico constpush con el resultado.  Los argumentos ya
+ * estan convertidos al tipo de los parametros (ver arglist). */
+static bool fold_bltin(Expr *res, const Symbol *bltin, Cell *args)
+{
+    if (!builtin_is_foldable(bltin->bltin_index))
+        return false;
+
+    ConstArglist list = { .expr_list = NULL };
+    Cell        *p    = args;
+    bool         ok   = true;
+
+    for (int i = 0; ok && i < bltin->argums_len; i++) {
+        Expr      arg = { .cel = p, .typ = bltin->argums[i]->typref };
+        ConstExpr val;
+
+        ok = arg.cel < progp
+          && expr_const(&arg, p + arg.typ->t2i->constpush->n_cells, &val);
+        if (ok) {
+            DYNARRAY_GROW(list.expr_list, ConstExpr, 1, UQ_CONST_EXPR_INCRMNT);
+            list.expr_list[list.expr_list_len++] = val;
+            p += arg.typ->t2i->constpush->n_cells;
+        }
+    }
+
+    if (ok && p == progp) {
+        ConstExpr val = fold_builtin_func(bltin->bltin_index, &list);
+        val.cel = const_conv_val(val.typ, bltin->typref, val.cel);
+        val.typ = bltin->typref;
+        *res = code_const(args, val);
+    } else {
+        ok = false;
+    }
+    free(list.expr_list);
+
+    return ok;
+} /* fold_bltin */
+
+static ConstExpr const_neg(ConstExpr exp)
+{
+    if        (exp.typ == Char) {
+        exp.cel.chr = - exp.cel.chr;
+    } else if (exp.typ == Short) {
+        exp.cel.sht = - exp.cel.sht;
+    } else if (exp.typ == Integer) {
+        exp.cel.itg = - exp.cel.itg;
+    } else if (exp.typ == Long) {
+        exp.cel.lng = - exp.cel.lng;
+    } else if (exp.typ == Float) {
+        exp.cel.flt = - exp.cel.flt;
+    } else if (exp.typ == Double) {
+        exp.cel.dbl = - exp.cel.dbl;
+    } else {
+        execerror(GREEN "%s" ANSI_END " invalid",
+                exp.typ->name);
+    }
+    return exp;
+} /* const_neg */
+
+static ConstExpr const_not(ConstExpr exp)
+{
+    ConstExpr ret_val = { .typ = Integer };
+
+    if        (exp.typ == Char) {
+        ret_val.cel.itg = ! exp.cel.chr;
+    } else if (exp.typ == Short) {
+        ret_val.cel.itg = ! exp.cel.sht;
+    } else if (exp.typ == Integer) {
+        ret_val.cel.itg = ! exp.cel.itg;
+    } else if (exp.typ == Long) {
+        ret_val.cel.itg = ! exp.cel.lng;
+    } else if (exp.typ == Float) {
+        ret_val.cel.itg = ! exp.cel.flt;
+    } else if (exp.typ == Double) {
+        ret_val.cel.itg = ! exp.cel.dbl;
+    } else {
+        execerror(GREEN "%s" ANSI_END " invalid",
+                exp.typ->name);
+    }
+    return ret_val;
+} /* const_not */
+
+static ConstExpr const_bit_not(ConstExpr exp)
+{
+    if        (exp.typ == Char) {
+        exp.cel.chr = ~ exp.cel.chr;
+    } else if (exp.typ == Short) {
+        exp.cel.sht = ~ exp.cel.sht;
+    } else if (exp.typ == Integer) {
+        exp.cel.itg = ~ exp.cel.itg;
+    } else if (exp.typ == Long) {
+        exp.cel.lng = ~ exp.cel.lng;
+    } else {
+        execerror(GREEN "%s" ANSI_END " invalid",
+                exp.typ->name);
+    }
+    return exp;
+} /* const_bit_not */
+
 OpRel code_unpatched_op(token tok)
 {
     OpRel ret_val = { .tok = tok, .start = progp };
@@ -1768,14 +2081,23 @@ const Symbol *check_op_bin(const Expr *exp1, OpRel *op, const Expr *exp2)
         return exp1->typ;
 
     if (exp1->typ->t2i->weight > exp2->typ->t2i->weight) { /* greater */
-        code_conv_val(exp2->typ, exp1->typ);
+        code_conv_expr(exp2, exp1->typ);
         return exp1->typ;
     }
 
     /* less */
-    BEGIN_PATCHING_CODE(op->start);
-        code_conv_val(exp1->typ, exp2->typ);
-    END_PATCHING_CODE();
+    ConstExpr val;
+    if (expr_const(exp1, op->start, &val)) {
+        /* se convierte el literal, y el noop queda como esta */
+        BEGIN_PATCHING_CODE(exp1->cel);
+            CODE_INST_TYP(exp2->typ, constpush,
+                    const_conv_val(val.typ, exp2->typ, val.cel));
+        END_PATCHING_CODE();
+    } else {
+        BEGIN_PATCHING_CODE(op->start);
+            code_conv_val(exp1->typ, exp2->typ);
+        END_PATCHING_CODE();
+    }
 
     return exp2->typ;
 
@@ -1884,6 +2206,15 @@ const_arglist_add(
 
 void patch_block(Cell*patch_point)
 {
+    /* el enter de una subrutina reserva las locales, y leave_ret
+     * las libera */
+    if (patch_point->inst == INST_enter) {
+        BEGIN_PATCHING_CODE(patch_point);
+            CODE_INST(enter, size_lvars);
+        END_PATCHING_CODE();
+        size_lvars = 0;
+        return;
+    }
     if (size_lvars != 0) {
         BEGIN_PATCHING_CODE(patch_point);
             CODE_INST(spadd, -size_lvars);
@@ -1893,6 +2224,32 @@ void patch_block(Cell*patch_point)
     }
 } /* patch_block */
 
+/* cierra el ambito de un bloque ('{' o for) que empieza en start
+ * y, si es el mas externo, reserva sus locales */
+void close_block(Cell *start)
+{
+    scope *cs = get_current_scope();
+
+    if (cs->base_offset + cs->size > size_lvars) {
+        size_lvars = cs->base_offset + cs->size;
+        PT("*** UPDATING size_lvars TO %zd\n", size_lvars);
+    }
+    if (get_root_scope() == cs) {
+        patch_block(start);
+    }
+    end_scope();
+} /* close_block */
+
+/* el contador de un for es una variable int o long */
+void check_for_counter(const Symbol *var)
+{
+    if (var->typref->t2i->loop_inc_goto == NULL) {
+        execerror("for counter " BRIGHT GREEN "%s" ANSI_END
+                  " must be int or long (is %s)",
+                  var->name, var->typref->name);
+    }
+} /* check_for_counter */
+
 void add_patch_return(Symbol *subr, Cell *patch_point)
 {
     DYNARRAY_GROW(
@@ -1904,18 +2261,42 @@ void add_patch_return(Symbol *subr, Cell *patch_point)
             = patch_point;
 } /* add_patch_return */
 
-void patch_returns(const Symbol *subr, Cell *target)
+/* cada return retorna directamente, sin saltar al final */
+void patch_returns(const Symbol *subr)
 {
     BEGIN_PATCHING_CODE(progp);
         /* para cada punto a parchear */
         for (int i = 0; i < subr->returns_to_patch_len; ++i) {
             Cell *point_to_patch = subr->returns_to_patch[i];
             CHANGE_PATCHING_TO(point_to_patch);
-            CODE_INST(Goto, target);
+            code_leave(subr);
         }
     END_PATCHING_CODE();
 } /* patch_returns */
 
+/* postambulo de subr: libera las locales, retorna y saca los
+ * argumentos, dejando el valor de las funciones en su lugar */
+Cell *code_leave(const Symbol *subr)
+{
+    if (subr->type == FUNCTION)
+        return CODE_INST(leave_ret_val, subr->size_args);
+    return CODE_INST(leave_ret, subr->size_args);
+} /* code_leave */
+
+/* el valor a retornar de una funcion es su primera local, que
+ * leave_ret_val mete en la pila.  Las demas van detras. */
+void reserve_ret_val(Symbol *subr)
+{
+    scope *cs = get_current_scope();
+
+    cs->size = 0;
+    if (subr->type == FUNCTION) {
+        cs->size             = subr->typref->t2i->size;
+        subr->ret_val_offset = -cs->size;
+        PT("+++ RET_VAL offset = %d\n", subr->ret_val_offset);
+    }
+} /* reserve_ret_val */
+
 void yyerror(char *s)   /* called for yacc syntax error */
 {
     int          i    = 0;
@@ -13,6 +13,7 @@
 #include "config.h"
 #include "cellP.h"
 #include "symbolP.h"
+#include "progmem.h"
 
 static struct constant { /* constants */
     char *name;
@@ -62,6 +63,7 @@ static struct predefined_types { /* predefined types */
 
 void init(void)  /* install constants and built-ins in table */
 {
+    progmem_init();
 
     /* vamos con los tipos */
 
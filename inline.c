@@ -0,0 +1,246 @@
+/* inline.c -- pasada de la IR que expande en el sitio de la
+ * llamada las funciones y procedimientos peque;os.
+ * License: BSD
+ *
+ * Una llamada queda como
+ *
+ *   args...
+ *   call  f
+ *
+ * y el codigo de f es enter, cuerpo y leave_ret (leave_ret_val
+ * en las funciones), con los argumentos en
+ * fp + UQ_SIZE_FP_RETADDR... y el resultado ({RET_VAL}) en la
+ * primera local.  Se sustituye call por:
+ *
+ *   argassign A0; drop ...   saca los argumentos a locales nuevas
+ *   cuerpo                   con los argumentos y las locales de
+ *                            f en locales nuevas
+ *   argeval R                (solo funciones) mete el resultado
+ *
+ * donde los return (leave_ret en medio de f) saltan al final del
+ * cuerpo.  Cada llamada expandida usa sus propias locales, ya
+ * que el cuerpo puede tener otras llamadas que se expanden a su
+ * vez.
+ *
+ * Se expanden las subrutinas ya definidas que no se llaman a si
+ * mismas y que ocupan hasta UQ_INLINE_MAX_CELLS celdas, o las
+ * declaradas con inline, sin limite de tama;o, salvo las que
+ * usan brkpt o symbs_all, que muestran su marco, y las que
+ * tienen un return dentro de un for.  Como una
+ * subrutina solo puede llamar a las definidas antes, la
+ * expansion siempre termina. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+
+#include "cellP.h"
+#include "symbolP.h"
+#include "code.h"
+#include "dynarray.h"
+#include "instr.h"
+#include "ir.h"
+#include "types.h"
+
+#ifndef   UQ_INLINE_MAX_CELLS /* { */
+#warning  UQ_INLINE_MAX_CELLS should be defined in config.mk
+#define   UQ_INLINE_MAX_CELLS   (32)
+#endif /* UQ_INLINE_MAX_CELLS    } */
+
+#ifndef   UQ_INLINE_MAX_SITES /* { */
+#warning  UQ_INLINE_MAX_SITES should be defined in config.mk
+#define   UQ_INLINE_MAX_SITES   (64)
+#endif /* UQ_INLINE_MAX_SITES    } */
+
+#ifndef   UQ_SIZE_FP_RETADDR /* { */
+#warning  UQ_SIZE_FP_RETADDR should be defined in config.mk
+#define   UQ_SIZE_FP_RETADDR    (2)
+#endif /* UQ_SIZE_FP_RETADDR    } */
+
+#ifndef   UQ_IR_INCRMNT /* { */
+#warning  UQ_IR_INCRMNT should be defined in config.mk
+#define   UQ_IR_INCRMNT         (256)
+#endif /* UQ_IR_INCRMNT    } */
+
+static bool inlinable(const ir_func *f, const Symbol *callee)
+{
+    if (callee == f->subr || callee->defn_end == NULL)
+        return false;
+    if (!callee->is_inline
+            && callee->defn_end - callee->defn > UQ_INLINE_MAX_CELLS)
+        return false;
+
+    /* un argumento, o el resultado, por celda */
+    if (callee->typref != NULL && callee->typref->t2i->size != 1)
+        return false;
+    for (size_t k = 0; k < callee->argums_len; k++)
+        if (callee->argums[k]->typref->t2i->size != 1)
+            return false;
+
+    for (   const Cell *p = callee->defn;
+            p < callee->defn_end;
+            p += instruction_table[p->inst].n_cells)
+    {
+        if (p->inst == INST_call && p[1].sym == callee)
+            return false;
+
+        /* muestran las variables del marco de la subrutina */
+        if (p->inst == INST_brkpt || p->inst == INST_symbs_all)
+            return false;
+    }
+    return true;
+} /* inlinable */
+
+/* nueva local para el desplazamiento off del marco de callee.  Las
+ * locales de la expansion empiezan en -(base + 1): primero los
+ * argumentos y luego las locales de callee (el resultado es la
+ * primera).  Devuelve 0 si off no es de ninguna de ellas. */
+static long remap(const Symbol *callee, int base, long off)
+{
+    int nargs = callee->size_args;
+
+    if (off >= UQ_SIZE_FP_RETADDR && off < UQ_SIZE_FP_RETADDR + nargs)
+        return -(base + 1 + off - UQ_SIZE_FP_RETADDR);
+    if (off < 0)
+        return -(base + nargs - off);
+    return 0;
+} /* remap */
+
+static bool is_leave(instr_code op)
+{
+    return op == INST_leave_ret || op == INST_leave_ret_val;
+} /* is_leave */
+
+/* un return dentro de un for deja de sacar el limite del bucle de
+ * la pila (ver hoc.y) cuando pasa a ser un Goto */
+static bool leaves_loop(const ir_func *g)
+{
+    for (int j = 0; j < g->nodes_len; j++) {
+        if (!ir_is_loop(g->nodes + j))
+            continue;
+        for (int k = g->nodes[j].target; k < j; k++)
+            if (is_leave(g->nodes[k].op))
+                return true;
+    }
+    return false;
+} /* leaves_loop */
+
+/* expande la llamada del nodo c, con sus locales a partir de
+ * -(base + 1).  Devuelve el numero de locales usadas, o -1 si no
+ * se ha podido. */
+static int inline_site(ir_func *f, int c, int base)
+{
+    const ir_node *call   = f->nodes + c;
+    const Symbol  *callee = call->cel[1].sym;
+    int            lin    = call->lin,
+                   col    = call->col;
+
+    ir_func g;
+    if (!ir_build(&g, (Symbol *) callee, callee->defn, callee->defn_end))
+        return -1;
+
+    /* las locales de callee pasan al marco de f, y su enter sobra */
+    int locals = ir_frame_size(&g);
+    if (locals < 0 || leaves_loop(&g)) {
+        ir_free(&g);
+        return -1;
+    }
+
+    int      hasret   = callee->typref != NULL,
+             body_len = g.nodes_len - 2,   /* sin enter ni el leave_ret
+                                            * final */
+             seq_len  = 2 * callee->argums_len + body_len + hasret,
+             k        = 0;
+    ir_node *seq      = malloc(seq_len * sizeof *seq);
+
+    /* los argumentos, empezando por el top de la pila */
+    for (long off = UQ_SIZE_FP_RETADDR;
+            off < UQ_SIZE_FP_RETADDR + callee->size_args;
+            off++)
+    {
+        const Symbol *arg = NULL;
+        for (size_t j = 0; j < callee->argums_len; j++)
+            if (callee->argums[j]->offset == off)
+                arg = callee->argums[j];
+        if (arg == NULL)
+            goto fail;
+
+        seq[k] = ir_make(arg->typref->t2i->argassign->code_id, lin, col);
+        seq[k].cel[0].param = remap(callee, base, off);
+        seq[k++].cel[1].str = arg->name;
+        seq[k++] = ir_make(INST_drop, lin, col);
+    }
+
+    /* el cuerpo, con los return saltando al final */
+    int first = k,
+        end   = first + body_len;
+    for (int j = 1; j < g.nodes_len - 1; j++) {
+        ir_node *n = seq + k++;
+
+        *n = g.nodes[j];
+        if (is_leave(n->op)) {
+            *n = ir_make(INST_Goto, n->lin, n->col);
+            n->target = end;
+        } else if (n->target >= 0) {
+            if (n->target < 1 || n->target > g.nodes_len - 1)
+                goto fail;
+            n->target += first - 1;
+        }
+        int a = ir_arg_cell(n);
+        if (a >= 0) {
+            n->cel[a].param = remap(callee, base, n->cel[a].param);
+            if (n->cel[a].param == 0)
+                goto fail;
+        }
+    }
+
+    if (hasret) {
+        const type2inst *typ = callee->typref->t2i;
+
+        seq[k]   = ir_make(typ->argeval->code_id, lin, col);
+        seq[k].cel[0].param = remap(callee, base, callee->ret_val_offset);
+        seq[k++].cel[1].str = "{RET_VAL} ";
+    }
+
+    ir_splice(f, c, 1, seq, seq_len);
+    free(seq);
+    ir_free(&g);
+
+    return callee->size_args + locals;
+
+fail:
+    free(seq);
+    ir_free(&g);
+    return -1;
+} /* inline_site */
+
+bool ir_pass_inline(ir_func *f)
+{
+    int size  = ir_frame_size(f),
+        used  = 0,
+        sites = 0;
+
+    if (size < 0)
+        return false;
+
+    /* el cuerpo expandido puede tener a su vez llamadas, que se
+     * encuentran al seguir recorriendo f */
+    for (int c = 0; c < f->nodes_len && sites < UQ_INLINE_MAX_SITES; c++) {
+        if (f->nodes[c].op != INST_call
+                || !inlinable(f, f->nodes[c].cel[1].sym))
+            continue;
+
+        int n = inline_site(f, c, size + used);
+        if (n >= 0) {
+            used += n;
+            sites++;
+            c--;     /* el nodo c es ahora el primero de la expansion */
+        }
+    }
+    if (sites > 0)
+        ir_frame_reserve(f, size + used);
+
+    return sites > 0;
+} /* ir_pass_inline */
@@ -6,10 +6,21 @@
  * License: BSD
  */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "config.h"
+#include "cellP.h"
 #include "code.h"
+#include "dynarray.h"
+#include "error.h"
 #include "instr.h"
 
+#ifndef   UQ_INSTR_EXT_INCRMNT /* { */
+#warning  UQ_INSTR_EXT_INCRMNT should be defined in config.mk
+#define   UQ_INSTR_EXT_INCRMNT  (8)
+#endif /* UQ_INSTR_EXT_INCRMNT    } */
+
 #define NELEM(_arr) (sizeof _arr / sizeof _arr[0])
 
 /* LCU: Mon Mar 24 12:23:36 -05 2025
@@ -24,6 +35,8 @@
  *   ejecutando el programa.
  * * .print es la funcion que se ejecuta para imprimir
  *   el listado del programa.
+ * * .stk_pop y .stk_push son las celdas que la instruccion
+ *   saca y mete en la pila (macro STK()).
  * Nota: la instruccion especial STOP, que para la maquina
  * virtual, se implementa la primera y con punteros nulos
  * a las funciones.  Este es el codigo que se genera en
@@ -31,23 +44,96 @@
  * para luego llamar al fichero "instrucciones.h" con las
  * definiciones de las instrucciones propiamente dichas */
 const instr instruction_set[] = {
-#define INST(_nom,_n, ...)        \
+#define INST(_nom,_n,_stk, ...)   \
     [INST_##_nom] = {             \
         .code_id  = INST_##_nom,  \
         .n_cells  = _n,           \
         .name     = #_nom,        \
         .exec     = _nom,         \
         .print    = _nom##_prt,   \
+        _stk                      \
         __VA_ARGS__               \
     },
 #define SUFF(_typ, _nom, _suf)     \
         ._suf     = _nom##_##_suf,
+#define STK(_pop, _push)           \
+        .stk_pop  = _pop,          \
+        .stk_push = _push,
 #include "instrucciones.h"
 #undef INST
 #undef SUFF
+#undef STK
 }; /* instruction_set[] */
 
 const size_t instruction_set_len
     = NELEM(instruction_set);
 
+const instr *instruction_table     = instruction_set;
+size_t       instruction_table_len = NELEM(instruction_set);
+const instr *instruction_impl      = instruction_set;
+
+static instr *ext_table;           /* copia ampliada de instruction_set */
+static size_t ext_table_len,
+              ext_table_cap;
+
+static void (*exec_wrapper)(const instr *);
+static instr *wrap_table;          /* copia de instruction_impl con
+                                    * exec_wrapper en todos los exec */
+static size_t wrap_table_len,
+              wrap_table_cap;
+
+/* recalcula instruction_table a partir de instruction_impl,
+ * tras registrar una instruccion o cambiar el envoltorio */
+static void update_dispatch(void)
+{
+    if (exec_wrapper == NULL) {
+        instruction_table = instruction_impl;
+        return;
+    }
+    wrap_table_len = 0;
+    DYNARRAY_GROW(wrap_table, instr, instruction_table_len,
+            UQ_INSTR_EXT_INCRMNT);
+    memcpy(wrap_table, instruction_impl,
+            instruction_table_len * sizeof *wrap_table);
+    wrap_table_len = instruction_table_len;
+    for (size_t j = 0; j < wrap_table_len; j++)
+        wrap_table[j].exec = exec_wrapper;
+    instruction_table = wrap_table;
+} /* update_dispatch */
+
+void
+set_instruction_wrapper(
+        void        (*exec)(const instr *))
+{
+    exec_wrapper = exec;
+    update_dispatch();
+} /* set_instruction_wrapper */
+
+int
+register_instruction(
+        const instr  *tmpl)
+{
+    if (instruction_table_len >= CELL_MAX_INSTRUCTIONS) {
+        warning("no room for instruction %s, ignored",
+                tmpl->name);
+        return -1;
+    }
+    if (ext_table == NULL) {
+        ext_table_len = instruction_set_len;
+        DYNARRAY_GROW(ext_table, instr, 0, UQ_INSTR_EXT_INCRMNT);
+        memcpy(ext_table, instruction_set, sizeof instruction_set);
+    }
+    DYNARRAY_GROW(ext_table, instr, 1, UQ_INSTR_EXT_INCRMNT);
+
+    instr *ret_val   = ext_table + ext_table_len++;
+    *ret_val         = *tmpl;
+    ret_val->code_id = ret_val - ext_table;
+
+    instruction_impl      = ext_table;
+    instruction_table_len = ext_table_len;
+    update_dispatch();
+
+    return ret_val->code_id;
+} /* register_instruction */
+
 /* instr.c */
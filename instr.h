@@ -32,10 +32,23 @@ enum instr_code_e {
 
 #undef  INST
 #undef  SUFF
+
+    INST_EXTENSION_BASE, /* primer codigo de las instrucciones
+                          * registradas por los plugins */
 }; /* enum instr_code_e */
 
 #include "cell.h"
 
+#define STK_VAR (-1) /* efecto en la pila no fijo (ver instrucciones.h) */
+
+struct const_expr_s;
+struct ConstArglist_s;
+
+typedef struct const_expr_s
+            (*instr_const_cb)(
+                const instr                 *i,
+                const struct ConstArglist_s *args);
+
 struct instr {
     instr_code    code_id;
     int           n_cells; /* numero de celdas que ocupa la instruccion */
@@ -43,9 +56,44 @@ struct instr {
     void        (*exec)(const instr *);
     void        (*print)(const instr *, const Cell *);
     void        (*prog)(const instr *, Cell *progp, va_list args);
+    int           stk_pop,  /* celdas que saca de la pila */
+                  stk_push; /* celdas que mete en la pila */
+    instr_const_cb const_eval; /* evaluacion en expresiones constantes
+                                * (solo instrucciones de plugins) */
 };
 
 extern const instr  instruction_set[];
 extern const size_t instruction_set_len;
 
+/* tabla de instrucciones que usa la maquina virtual.  Al principio
+ * apunta a instruction_set[], pero cuando un plugin registra una
+ * instruccion nueva se sustituye por una copia ampliada, de forma
+ * que las instrucciones de los plugins tienen codigos a partir de
+ * INST_EXTENSION_BASE. */
+extern const instr *instruction_table;
+extern size_t       instruction_table_len;
+
+/* instruction_impl es la tabla con las funciones exec reales.
+ * Normalmente coincide con instruction_table, pero si se
+ * instala un envoltorio con set_instruction_wrapper(), la
+ * maquina despacha a traves de una copia de la tabla en la
+ * que todos los exec son el envoltorio, que debe llamar a
+ * instruction_impl[i->code_id].exec.  Sin envoltorio, el
+ * bucle de execute() no tiene ningun coste a;adido.
+ * No debe cambiarse durante una ejecucion (execute() compara
+ * con la entrada de STOP de la tabla al entrar).  Con NULL se
+ * quita el envoltorio. */
+extern const instr *instruction_impl;
+
+void
+set_instruction_wrapper(
+        void        (*exec)(const instr *));
+
+/* registra una nueva instruccion, copiando la plantilla tmpl (el
+ * campo code_id se ignora) y devuelve su codigo, o -1 si no caben
+ * mas instrucciones. */
+int
+register_instruction(
+        const instr  *tmpl);
+
 #endif /* INSTR_H_c9973130_ace9_11f0_aae7_0023ae68f329 */
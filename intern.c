@@ -15,6 +15,7 @@
 static const char **cadenas;
 size_t              cadenas_len,
                     cadenas_cap;
+static size_t       cadenas_bytes;
 
 #ifndef   UQ_INTERN_INCRMNT /* { */
 #warning  UQ_INTERN_INCRMNT should be defined in 'config.mk'
@@ -29,5 +30,12 @@ const char *intern(
             return cadenas[i];
     }
     DYNARRAY_GROW(cadenas, const char *, 1, UQ_INTERN_INCRMNT);
+    cadenas_bytes += strlen(name) + 1;
     return cadenas[cadenas_len++] = strdup(name);
 } /* intern */
+
+void intern_stats(size_t *count, size_t *bytes)
+{
+    *count = cadenas_len;
+    *bytes = cadenas_bytes;
+} /* intern_stats */
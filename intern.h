@@ -7,6 +7,11 @@
 #ifndef INTERN_H_21513e0c_acea_11f0_93b0_0023ae68f329
 #define INTERN_H_21513e0c_acea_11f0_93b0_0023ae68f329
 
+#include <stddef.h>
+
 const char *intern(const char *name);
 
+/* numero de cadenas internalizadas y bytes que ocupan */
+void intern_stats(size_t *count, size_t *bytes);
+
 #endif /* INTERN_H_21513e0c_acea_11f0_93b0_0023ae68f329 */
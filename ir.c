@@ -0,0 +1,797 @@
+/* ir.c -- representacion intermedia del codigo de cada funcion,
+ * gestor de pasadas de optimizacion y regeneracion del codigo.
+ * License: BSD
+ *
+ * hoc.y genera el codigo directamente desde las acciones de la
+ * gramatica, parcheando direcciones sobre la marcha, y eso hace
+ * que cualquier optimizacion sea un apa;o en la gramatica.  Por
+ * eso, cuando termina una funcion (en patching_subr(), con todo
+ * ya parcheado) o una sentencia de nivel superior (antes de
+ * ejecutarla), su codigo se convierte en una lista de nodos
+ * (ir_func), una instruccion por nodo, en la que los saltos
+ * apuntan a nodos y no a direcciones.  Sobre esa lista se pasan
+ * las pasadas de optimizacion registradas en passes[], que
+ * pueden borrar e insertar nodos sin preocuparse de las
+ * direcciones, y si alguna ha cambiado algo se regenera el
+ * codigo en el mismo sitio con code_inst(), calculando de nuevo
+ * las direcciones de salto y la tabla de lineas.
+ *
+ * La maquina es de pila, asi que cada subexpresion ocupa un
+ * rango contiguo de nodos, que se puede localizar con los
+ * efectos en la pila de cada instruccion (ver ir_stk_pop() y
+ * ir_stk_push()). */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+
+#include "cellP.h"
+#include "symbolP.h"
+#include "builtins.h"
+#include "builtinsP.h"
+#include "code.h"
+#include "dynarray.h"
+#include "instr.h"
+#include "ir.h"
+#include "lines.h"
+#include "types.h"
+
+#ifndef   UQ_IR_INCRMNT /* { */
+#warning  UQ_IR_INCRMNT should be defined in config.mk
+#define   UQ_IR_INCRMNT         (256)
+#endif /* UQ_IR_INCRMNT    } */
+
+/* PASADAS */
+
+/* los noop que quedan de los parcheos (operadores sin conversion,
+ * bloques sin variables locales) no hacen nada */
+static bool pass_noops(ir_func *f)
+{
+    bool changed = false;
+
+    for (int i = 0; i < f->nodes_len; i++) {
+        if (f->nodes[i].op == INST_noop) {
+            ir_delete(f, i);
+            changed = true;
+        }
+    }
+    return changed;
+} /* pass_noops */
+
+/* spadd seguidos (la limpieza de los argumentos de una llamada y
+ * la reserva del valor de la siguiente, p.ej.) se suman en uno,
+ * o desaparecen si se anulan */
+static bool pass_spadd(ir_func *f)
+{
+    bool *tgt     = ir_jump_targets(f);
+    bool  changed = false;
+
+    for (int i = 0, j; i < f->nodes_len; i = j) {
+        j = i + 1;
+        if (f->nodes[i].op != INST_spadd)
+            continue;
+        long sum = f->nodes[i].cel[0].param;
+        for (; j < f->nodes_len && f->nodes[j].op == INST_spadd
+                && !tgt[j]; j++)
+        {
+            sum += f->nodes[j].cel[0].param;
+            ir_delete(f, j);
+            changed = true;
+        }
+        if (sum == 0) {
+            ir_delete(f, i);
+            changed = true;
+        }
+        f->nodes[i].cel[0].param = sum;
+    }
+    free(tgt);
+
+    return changed;
+} /* pass_spadd */
+
+/* en el orden en que se ejecutan.  inline va antes que dce, que
+ * limpia lo que deja la expansion (el salto del ultimo return al
+ * final del cuerpo, las locales que no se leen...) */
+static struct ir_pass_s {
+    const char *name;
+    ir_pass_cb  run;
+    bool        enabled;
+} passes[] = {
+    { "noops",    pass_noops,       true },
+    { "inline",   ir_pass_inline,   true },
+    { "dce",      ir_pass_dce,      true },
+    { "licm",     ir_pass_licm,     true },
+    { "cse",      ir_pass_cse,      true },
+    { "strength", ir_pass_strength, true },
+    { "spadd",    pass_spadd,       true },
+};
+
+#define N_PASSES (sizeof passes / sizeof passes[0])
+
+/* NODOS */
+
+bool ir_is_jump(const ir_node *n)
+{
+    return instruction_table[n->op].prog == addr_prog || ir_is_loop(n);
+} /* ir_is_jump */
+
+bool ir_is_loop(const ir_node *n)
+{
+    const instr *i = instruction_table + n->op;
+
+    return i->prog == loop_symb_prog || i->prog == loop_arg_prog;
+} /* ir_is_loop */
+
+int ir_arg_cell(const ir_node *n)
+{
+    const instr *i = instruction_table + n->op;
+
+    if (i->prog == arg_str_prog)
+        return 0;
+    if (i->prog == loop_arg_prog)
+        return 1;
+    return -1;
+} /* ir_arg_cell */
+
+bool *ir_jump_targets(const ir_func *f)
+{
+    bool *ret_val = calloc(f->nodes_len + 1, sizeof *ret_val);
+
+    assert(ret_val != NULL);
+    for (int i = 0; i < f->nodes_len; i++) {
+        if (f->nodes[i].target >= 0)
+            ret_val[f->nodes[i].target] = true;
+    }
+    return ret_val;
+} /* ir_jump_targets */
+
+int ir_stk_pop(const ir_node *n)
+{
+    return instruction_table[n->op].stk_pop;
+} /* ir_stk_pop */
+
+int ir_stk_push(const ir_node *n)
+{
+    return instruction_table[n->op].stk_push;
+} /* ir_stk_push */
+
+ir_node ir_make(instr_code op, int lin, int col)
+{
+    ir_node ret_val = {
+        .op     = op,
+        .target = -1,
+        .lin    = lin,
+        .col    = col,
+    };
+    ret_val.cel[0].inst = op;
+    return ret_val;
+} /* ir_make */
+
+ir_node *ir_insert(ir_func *f, int idx, const ir_node *n)
+{
+    assert(idx >= 0 && idx <= f->nodes_len);
+
+    DYNARRAY_GROW(f->nodes, ir_node, 1, UQ_IR_INCRMNT);
+    memmove(f->nodes + idx + 1, f->nodes + idx,
+            (f->nodes_len - idx) * sizeof f->nodes[0]);
+    f->nodes_len++;
+
+    for (int i = 0; i < f->nodes_len; i++) {
+        if (i != idx && f->nodes[i].target >= idx)
+            f->nodes[i].target++;
+    }
+    f->nodes[idx] = *n;
+    return f->nodes + idx;
+} /* ir_insert */
+
+void ir_delete(ir_func *f, int idx)
+{
+    assert(idx >= 0 && idx < f->nodes_len);
+    f->nodes[idx].dead = true;
+} /* ir_delete */
+
+void ir_compact(ir_func *f)
+{
+    int *map = malloc((f->nodes_len + 1) * sizeof *map);
+    int  n   = 0;
+
+    assert(map != NULL);
+    for (int i = 0; i < f->nodes_len; i++)
+        map[i] = f->nodes[i].dead ? -1 : n++;
+    map[f->nodes_len] = n;
+
+    /* un nodo borrado se sustituye por el siguiente que no lo este */
+    for (int i = f->nodes_len - 1; i >= 0; i--) {
+        if (map[i] < 0)
+            map[i] = map[i + 1];
+    }
+
+    n = 0;
+    for (int i = 0; i < f->nodes_len; i++) {
+        if (f->nodes[i].dead)
+            continue;
+        ir_node *nd = f->nodes + n++;
+        *nd = f->nodes[i];
+        if (nd->target >= 0)
+            nd->target = map[nd->target];
+    }
+    f->nodes_len = n;
+    free(map);
+} /* ir_compact */
+
+void ir_splice(ir_func *f, int idx, int n_del,
+        const ir_node *seq, int seq_len)
+{
+    int delta = seq_len - n_del;
+
+    assert(idx >= 0 && idx + n_del <= f->nodes_len);
+    for (int i = 0; i < f->nodes_len; i++) {
+        int *t = &f->nodes[i].target;
+
+        if (*t > idx && *t < idx + n_del)
+            *t = idx + seq_len;
+        else if (*t >= idx + n_del)
+            *t += delta;
+    }
+
+    if (delta > 0)
+        DYNARRAY_GROW(f->nodes, ir_node, delta, UQ_IR_INCRMNT);
+    memmove(f->nodes + idx + seq_len, f->nodes + idx + n_del,
+            (f->nodes_len - idx - n_del) * sizeof f->nodes[0]);
+    f->nodes_len += delta;
+
+    for (int k = 0; k < seq_len; k++) {
+        ir_node *n = f->nodes + idx + k;
+
+        *n = seq[k];
+        if (n->target >= 0)
+            n->target += idx;
+    }
+} /* ir_splice */
+
+/* ANALISIS */
+
+static const type2inst *const all_t2i[] = {
+    &t2i_c, &t2i_d, &t2i_f, &t2i_i, &t2i_l, &t2i_s,
+};
+
+#define N_T2I (sizeof all_t2i / sizeof all_t2i[0])
+
+static bool is_op(const instr *i, instr_code op)
+{
+    return i != NULL && i->code_id == op;
+} /* is_op */
+
+static const type2inst *t2i_of_suffix(char suff)
+{
+    switch (suff) {
+    case 'c': return &t2i_c;
+    case 'd': return &t2i_d;
+    case 'f': return &t2i_f;
+    case 'i': return &t2i_i;
+    case 'l': return &t2i_l;
+    case 's': return &t2i_s;
+    }
+    return NULL;
+} /* t2i_of_suffix */
+
+static bool is_assign(instr_code op)
+{
+    for (int k = 0; k < N_T2I; k++)
+        if (is_op(all_t2i[k]->assign, op))
+            return true;
+    return false;
+} /* is_assign */
+
+static bool is_argassign(instr_code op)
+{
+    for (int k = 0; k < N_T2I; k++)
+        if (is_op(all_t2i[k]->argassign, op))
+            return true;
+    return false;
+} /* is_argassign */
+
+static bool is_eval(instr_code op)
+{
+    for (int k = 0; k < N_T2I; k++)
+        if (is_op(all_t2i[k]->eval, op))
+            return true;
+    return false;
+} /* is_eval */
+
+static bool is_argeval(instr_code op)
+{
+    for (int k = 0; k < N_T2I; k++)
+        if (is_op(all_t2i[k]->argeval, op))
+            return true;
+    return false;
+} /* is_argeval */
+
+const type2inst *ir_result_t2i(const ir_node *n)
+{
+    instr_code op = n->op;
+
+    /* instrucciones en linea de los plugins: param es el builtin
+     * (ver code_bltin()).  Si no lo es, la instruccion es opaca. */
+    if (op >= INST_EXTENSION_BASE) {
+        const instr *i  = instruction_table + op;
+        long         id = n->cel[0].param;
+
+        if (i->stk_pop == STK_VAR || i->stk_push != 1
+                || builtin_inline_inst(id) != op
+                || !builtin_is_foldable(id))
+            return NULL;
+        return get_builtin_info(id)->sym->typref->t2i;
+    }
+
+    switch (op) {
+    case INST_bltin_dd:
+    case INST_bltin_ddd:
+        return builtin_is_foldable(n->cel[0].param) ? &t2i_d : NULL;
+    case INST_not:
+        return &t2i_i;
+    default:
+        break;
+    }
+
+    for (int k = 0; k < N_T2I; k++) {
+        const type2inst *t = all_t2i[k];
+
+        if (   is_op(t->ge, op) || is_op(t->le, op)
+            || is_op(t->gt, op) || is_op(t->lt, op)
+            || is_op(t->eq, op) || is_op(t->ne, op))
+            return &t2i_i;
+
+        if (   is_op(t->constpush, op) || is_op(t->eval,    op)
+            || is_op(t->argeval,   op) || is_op(t->add,     op)
+            || is_op(t->sub,       op) || is_op(t->mul,     op)
+            || is_op(t->divi,      op) || is_op(t->mod,     op)
+            || is_op(t->neg,       op) || is_op(t->pwr,     op)
+            || is_op(t->bit_not,   op) || is_op(t->bit_or,  op)
+            || is_op(t->bit_xor,   op) || is_op(t->bit_and, op)
+            || is_op(t->bit_shl,   op) || is_op(t->bit_shr, op)
+            || is_op(t->divk,      op) || is_op(t->modk,    op)
+            || is_op(t->divp2,     op) || is_op(t->modp2,   op))
+            return t;
+    }
+
+    /* conversiones: <origen>2<destino> */
+    const char *name = instruction_table[op].name;
+    if (strlen(name) == 3 && name[1] == '2')
+        return t2i_of_suffix(name[2]);
+
+    return NULL;
+} /* ir_result_t2i */
+
+bool ir_is_pure(const ir_node *n)
+{
+    return ir_result_t2i(n) != NULL;
+} /* ir_is_pure */
+
+bool ir_may_fail(const ir_node *n)
+{
+    if (n->op >= INST_EXTENSION_BASE)
+        return true;
+
+    const type2inst *t = ir_result_t2i(n);
+
+    /* divi_d y divi_f tambien dan "Division por 0" */
+    return t != NULL
+        && (   is_op(t->divi, n->op)
+            || is_op(t->mod,  n->op)
+            || ((t->flags & TYPE_IS_INTEGER) && is_op(t->pwr, n->op)));
+} /* ir_may_fail */
+
+int ir_expr_start(const ir_func *f, const bool *tgt, int end)
+{
+    int need = 1; /* valores que faltan por calcular */
+
+    for (int j = end; j >= 0; j--) {
+        const ir_node *n = f->nodes + j;
+
+        if (n->dead || !ir_is_pure(n))
+            return -1;
+        need += ir_stk_pop(n) - 1;
+        if (need == 0)
+            return j;
+        if (tgt[j])
+            return -1;
+    }
+    return -1;
+} /* ir_expr_start */
+
+static bool has_long(const long *v, size_t len, long x)
+{
+    for (size_t k = 0; k < len; k++)
+        if (v[k] == x)
+            return true;
+    return false;
+} /* has_long */
+
+static void clobber_gvar(ir_clobber *c, long addr)
+{
+    if (has_long(c->gvars, c->gvars_len, addr))
+        return;
+    DYNARRAY_GROW(c->gvars, long, 1, UQ_IR_INCRMNT);
+    c->gvars[c->gvars_len++] = addr;
+} /* clobber_gvar */
+
+static void clobber_slot(ir_clobber *c, long offset)
+{
+    if (has_long(c->slots, c->slots_len, offset))
+        return;
+    DYNARRAY_GROW(c->slots, long, 1, UQ_IR_INCRMNT);
+    c->slots[c->slots_len++] = offset;
+} /* clobber_slot */
+
+/* subrutinas ya recorridas por clobber_subr() */
+typedef struct seen_s {
+    const Symbol **subrs;
+    size_t         subrs_len,
+                   subrs_cap;
+} seen;
+
+/* globales que modifica subr y las que llama.  Las locales de
+ * subr estan en otro marco, y no cuentan. */
+static void clobber_subr(
+        const ir_func *f,
+        const Symbol  *subr,
+        ir_clobber    *c,
+        seen          *s)
+{
+    if (c->all_gvars)
+        return;
+    for (size_t k = 0; k < s->subrs_len; k++)
+        if (s->subrs[k] == subr)
+            return;
+    DYNARRAY_GROW(s->subrs, const Symbol *, 1, UQ_IR_INCRMNT);
+    s->subrs[s->subrs_len++] = subr;
+
+    /* llamada recursiva: el codigo esta en f */
+    if (subr == f->subr) {
+        for (int j = 0; j < f->nodes_len; j++) {
+            const ir_node *n = f->nodes + j;
+            if (is_assign(n->op))
+                clobber_gvar(c, n->cel[0].param);
+            else if (instruction_table[n->op].prog == loop_symb_prog)
+                clobber_gvar(c, n->cel[1].param);
+            else if (n->op == INST_call)
+                clobber_subr(f, n->cel[1].sym, c, s);
+        }
+        return;
+    }
+
+    /* todavia no se ha terminado de definir */
+    if (subr->defn_end == NULL) {
+        c->all_gvars = true;
+        return;
+    }
+
+    for (   const Cell *p = subr->defn;
+            p < subr->defn_end;
+            p += instruction_table[p->inst].n_cells)
+    {
+        if (p->inst >= instruction_table_len) {
+            c->all_gvars = true;
+            return;
+        }
+        if (is_assign(p->inst))
+            clobber_gvar(c, p->param);
+        else if (instruction_table[p->inst].prog == loop_symb_prog)
+            clobber_gvar(c, p[1].param);
+        else if (p->inst == INST_call)
+            clobber_subr(f, p[1].sym, c, s);
+    }
+} /* clobber_subr */
+
+void ir_clobber_range(const ir_func *f, int from, int to, ir_clobber *c)
+{
+    seen s = { 0 };
+
+    for (int j = from; j < to; j++) {
+        const ir_node *n = f->nodes + j;
+
+        if (n->dead)
+            continue;
+        if (is_assign(n->op))
+            clobber_gvar(c, n->cel[0].param);
+        else if (is_argassign(n->op))
+            clobber_slot(c, n->cel[0].param);
+        else if (instruction_table[n->op].prog == loop_symb_prog)
+            clobber_gvar(c, n->cel[1].param);
+        else if (instruction_table[n->op].prog == loop_arg_prog)
+            clobber_slot(c, n->cel[1].param);
+        else if (n->op == INST_call)
+            clobber_subr(f, n->cel[1].sym, c, &s);
+    }
+    free(s.subrs);
+} /* ir_clobber_range */
+
+bool ir_clobbers(const ir_clobber *c, const ir_node *n)
+{
+    if (is_eval(n->op))
+        return c->all_gvars
+            || has_long(c->gvars, c->gvars_len, n->cel[0].param);
+    if (is_argeval(n->op))
+        return has_long(c->slots, c->slots_len, n->cel[0].param);
+    return false;
+} /* ir_clobbers */
+
+void ir_clobber_free(ir_clobber *c)
+{
+    free(c->gvars);
+    free(c->slots);
+    memset(c, 0, sizeof *c);
+} /* ir_clobber_free */
+
+/* MARCO DE PILA */
+
+int ir_frame_size(const ir_func *f)
+{
+    const ir_node *nodes = f->nodes;
+    int            len   = f->nodes_len;
+
+    if (f->subr != NULL) {
+        if (len < 2
+                || nodes[0].op != INST_enter
+                || (   nodes[len - 1].op != INST_leave_ret
+                    && nodes[len - 1].op != INST_leave_ret_val))
+            return -1;
+    } else if (len < 1 || nodes[len - 1].op != INST_STOP) {
+        return -1;
+    }
+
+    int size = f->frame_cells;
+    for (int j = 0; j < len; j++) {
+        int a = ir_arg_cell(nodes + j);
+
+        if (a >= 0 && -nodes[j].cel[a].param > size)
+            size = -nodes[j].cel[a].param;
+    }
+    return size;
+} /* ir_frame_size */
+
+void ir_frame_reserve(ir_func *f, int size)
+{
+    int extra = size - f->frame_cells;
+
+    if (extra <= 0)
+        return;
+
+    /* en una subrutina basta con el enter del preambulo, pues
+     * leave_ret libera todo el marco */
+    if (f->subr != NULL) {
+        f->nodes[0].cel[0].param = size;
+        f->frame_cells           = size;
+        return;
+    }
+
+    /* en el nivel superior no se sabe cual es el spadd de las
+     * locales (frame_cells empieza en 0), y se reserva todo */
+    const ir_node *at = f->nodes;
+    ir_node        n  = ir_make(INST_spadd, at->lin, at->col);
+
+    n.cel[0].param = -extra;
+    ir_insert(f, 0, &n);
+
+    /* a la salida, delante de STOP */
+    int exit = f->nodes_len - 1;
+
+    at = f->nodes + exit;
+    n  = ir_make(INST_spadd, at->lin, at->col);
+    n.cel[0].param = extra;
+    ir_insert(f, exit, &n);
+    for (int j = 0; j < f->nodes_len; j++)
+        if (f->nodes[j].target == exit + 1)
+            f->nodes[j].target = exit;
+
+    f->frame_cells = size;
+} /* ir_frame_reserve */
+
+/* CONSTRUCCION */
+
+bool ir_build(ir_func *f, Symbol *subr, Cell *start, Cell *end)
+{
+    size_t len   = end - start;
+    int   *index = malloc((len + 1) * sizeof *index); /* nodo de cada celda */
+
+    assert(index != NULL);
+    memset(f, 0, sizeof *f);
+    f->subr  = subr;
+    f->start = start;
+
+    for (size_t k = 0; k <= len; k++)
+        index[k] = -1;
+
+    int lin = 0, col = 0;
+    for (Cell *p = start; p < end;) {
+        if (p->inst >= instruction_table_len)
+            goto fail;
+        const instr *i = instruction_table + p->inst;
+        if (i->n_cells > IR_MAX_CELLS || p + i->n_cells > end)
+            goto fail;
+
+        index[p - start] = f->nodes_len;
+        DYNARRAY_GROW(f->nodes, ir_node, 1, UQ_IR_INCRMNT);
+        ir_node *n = f->nodes + f->nodes_len++;
+
+        /* sin entrada en la tabla de lineas, la de la anterior */
+        lines_lookup(p - prog, &lin, &col);
+        *n = ir_make(p->inst, lin, col);
+        memcpy(n->cel, p, i->n_cells * sizeof *p);
+
+        p += i->n_cells;
+    }
+    index[len] = f->nodes_len;
+
+    /* el preambulo de una subrutina es el enter que reserva las
+     * locales */
+    if (subr != NULL && f->nodes_len > 0
+            && f->nodes[0].op == INST_enter)
+        f->frame_cells = f->nodes[0].cel[0].param;
+
+    for (int k = 0; k < f->nodes_len; k++) {
+        ir_node *n = f->nodes + k;
+        if (!ir_is_jump(n))
+            continue;
+        Cell *dest = prog + n->cel[0].param;
+        if (dest < start || dest > end || index[dest - start] < 0)
+            goto fail;
+        n->target = index[dest - start];
+    }
+
+    free(index);
+    return true;
+
+fail:
+    free(index);
+    ir_free(f);
+    return false;
+} /* ir_build */
+
+void ir_free(ir_func *f)
+{
+    free(f->nodes);
+    f->nodes     = NULL;
+    f->nodes_len =
+    f->nodes_cap = 0;
+} /* ir_free */
+
+/* REGENERACION */
+
+static bool is_datum_prog(void (*prog)(const instr *, Cell *, va_list))
+{
+    return prog == datum_c_prog || prog == datum_d_prog
+        || prog == datum_f_prog || prog == datum_i_prog
+        || prog == datum_l_prog || prog == datum_s_prog;
+} /* is_datum_prog */
+
+/* genera el nodo n.  code_inst() necesita los parametros que
+ * espera la funcion prog de la instruccion, que se sacan de las
+ * celdas guardadas; despues se restauran las celdas tal y como
+ * estaban, para no depender de lo que haga prog (las
+ * instrucciones de los plugins reciben el indice del builtin). */
+static void lower_node(const ir_node *n, Cell *dest)
+{
+    const instr *i = instruction_table + n->op;
+    Cell        *p;
+
+    if (i->prog == addr_prog) {
+        code_inst(n->op, dest);
+        return;
+    }
+    if (i->prog == loop_symb_prog) {
+        code_inst(n->op, dest, n->cel[2].sym, n->cel[3]);
+        return;
+    }
+    if (i->prog == loop_arg_prog) {
+        code_inst(n->op, dest, (int) n->cel[1].param, n->cel[2].str,
+                n->cel[3]);
+        return;
+    }
+
+    if (i->prog == NULL)
+        p = code_inst(n->op);
+    else if (i->prog == symb_prog)
+        p = code_inst(n->op, n->cel[1].sym);
+    else if (i->prog == arg_str_prog)
+        p = code_inst(n->op, (int) n->cel[0].param, n->cel[1].str);
+    else if (i->prog == str_prog)
+        p = code_inst(n->op, n->cel[1].str);
+    else if (is_datum_prog(i->prog))
+        p = code_inst(n->op, n->cel[1]);
+    else /* arg_prog, bltin_native_prog y las de los plugins */
+        p = code_inst(n->op, (int) n->cel[0].param);
+
+    p->param = n->cel[0].param;
+    for (int k = 1; k < i->n_cells; k++)
+        p[k] = n->cel[k];
+} /* lower_node */
+
+void ir_lower(const ir_func *f)
+{
+    long *addr = malloc((f->nodes_len + 1) * sizeof *addr);
+    long  a    = f->start - prog;
+
+    assert(addr != NULL);
+    for (int k = 0; k < f->nodes_len; k++) {
+        addr[k] = a;
+        a      += instruction_table[f->nodes[k].op].n_cells;
+    }
+    addr[f->nodes_len] = a;
+
+    /* la tabla de lineas se rehace con las posiciones de los nodos,
+     * anotandolas antes de que lo haga code_inst() con el ultimo
+     * token leido */
+    progp = f->start;
+    lines_truncate(f->start - prog);
+
+    for (int k = 0; k < f->nodes_len; k++) {
+        const ir_node *n = f->nodes + k;
+
+        lines_record(progp - prog, n->lin, n->col);
+        lower_node(n, n->target >= 0 ? prog + addr[n->target] : NULL);
+    }
+    free(addr);
+} /* ir_lower */
+
+/* GESTOR DE PASADAS */
+
+int ir_select_passes(const char *spec)
+{
+    bool all = strcmp(spec, "all") == 0;
+
+    for (int k = 0; k < N_PASSES; k++)
+        passes[k].enabled = all;
+    if (all || strcmp(spec, "none") == 0)
+        return 0;
+
+    char *copy = strdup(spec);
+    int   res  = 0;
+
+    for (   char *name = strtok(copy, ",");
+            name != NULL;
+            name = strtok(NULL, ","))
+    {
+        int k;
+        for (k = 0; k < N_PASSES; k++) {
+            if (strcmp(passes[k].name, name) == 0) {
+                passes[k].enabled = true;
+                break;
+            }
+        }
+        if (k == N_PASSES)
+            res = -1;
+    }
+    free(copy);
+
+    return res;
+} /* ir_select_passes */
+
+void ir_optimize(Symbol *subr, Cell *start, Cell *end)
+{
+    ir_func f;
+    bool    changed = false;
+
+    if (!ir_build(&f, subr, start, end))
+        return;
+
+    for (int k = 0; k < N_PASSES; k++) {
+        if (passes[k].enabled && passes[k].run(&f)) {
+            ir_compact(&f);
+            changed = true;
+        }
+    }
+
+    if (changed)
+        ir_lower(&f);
+
+    /* lo que reserva el enter del preambulo, con las temporales
+     * que hayan a;adido las pasadas */
+    if (subr != NULL)
+        subr->size_lvars = f.frame_cells;
+    ir_free(&f);
+} /* ir_optimize */
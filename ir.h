@@ -0,0 +1,189 @@
+/* ir.h -- representacion intermedia del codigo de cada funcion,
+ * gestor de pasadas de optimizacion y regeneracion del codigo.
+ * License: BSD
+ */
+#ifndef IR_H_3f0b9d2e_d117_11f0_8c4a_0023ae68f329
+#define IR_H_3f0b9d2e_d117_11f0_8c4a_0023ae68f329
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "cellP.h"
+#include "instr.h"
+#include "symbol.h"
+#include "types.h"
+
+/* celdas maximas de una instruccion que cabe en un ir_node.  Las
+ * funciones con instrucciones mas largas no se optimizan. */
+#define IR_MAX_CELLS   4
+
+/* un nodo es una instruccion de la maquina, con sus celdas, pero
+ * con la direccion de salto sustituida por el indice del nodo
+ * destino.  El orden de los nodos es el orden del codigo. */
+typedef struct ir_node_s {
+    instr_code  op;
+    Cell        cel[IR_MAX_CELLS];  /* celdas tal y como estaban en
+                                     * prog[] (cel[0].inst == op) */
+    int         target;             /* si es un salto, nodo destino
+                                     * (nodes_len es el final), si
+                                     * no, -1 */
+    int         lin,                /* posicion en el fuente */
+                col;
+    bool        dead;               /* borrado, ver ir_delete() */
+} ir_node;
+
+typedef struct ir_func_s {
+    Symbol     *subr;               /* NULL: codigo de nivel superior */
+    Cell       *start;              /* donde se regenera el codigo */
+    ir_node    *nodes;
+    size_t      nodes_len,
+                nodes_cap;
+    int         frame_cells;        /* celdas de locales que reserva
+                                     * el preambulo (ver
+                                     * ir_frame_reserve()) */
+} ir_func;
+
+/* una pasada devuelve true si ha modificado f.  Puede borrar
+ * nodos con ir_delete() (el gestor compacta f despues de cada
+ * pasada) e insertar nodos con ir_insert(). */
+typedef bool (*ir_pass_cb)(ir_func *f);
+
+/* construye f a partir del codigo [start, end) de subr.  Devuelve
+ * false (y f vacia) si el codigo tiene algo que la IR no sabe
+ * representar, p.ej. un salto fuera de [start, end]. */
+bool ir_build(ir_func *f, Symbol *subr, Cell *start, Cell *end);
+
+/* regenera el codigo de f, con code_inst(), a partir de f->start,
+ * y deja progp al final.  Reescribe la tabla de lineas. */
+void ir_lower(const ir_func *f);
+
+void ir_free(ir_func *f);
+
+/* inserta n delante del nodo idx.  Los saltos a idx siguen yendo
+ * al nodo que estaba en idx (el insertado solo se alcanza por
+ * la secuencia normal de ejecucion).  Si n es un salto, su
+ * target ya debe contar con la insercion.  Devuelve el nodo
+ * insertado. */
+ir_node *ir_insert(ir_func *f, int idx, const ir_node *n);
+
+/* marca el nodo idx como borrado.  Los saltos que iban a el iran
+ * al siguiente nodo no borrado. */
+void ir_delete(ir_func *f, int idx);
+
+/* elimina los nodos borrados y reajusta los saltos */
+void ir_compact(ir_func *f);
+
+/* sustituye los nodos [idx, idx + n_del) por los seq_len de seq.
+ * Los saltos de seq son relativos a seq (seq_len es el nodo que
+ * le sigue).  Los saltos que iban a idx van al primero de seq, y
+ * los que iban a otro de los nodos sustituidos, al que sigue. */
+void ir_splice(ir_func *f, int idx, int n_del,
+        const ir_node *seq, int seq_len);
+
+/* crea un nodo de la instruccion op, sin parametros */
+ir_node ir_make(instr_code op, int lin, int col);
+
+/* efecto en la pila de un nodo (STK_VAR si no es fijo) */
+int ir_stk_pop(const ir_node *n);
+int ir_stk_push(const ir_node *n);
+
+/* true si n es un salto (if_f_goto, Goto, and_then, or_else y los
+ * loop_inc_goto) */
+bool ir_is_jump(const ir_node *n);
+
+/* true si n es el loop_inc_goto (o argloop_inc_goto) del final de
+ * un for: salta hacia atras, al cuerpo, y lee y modifica el
+ * contador, cuya direccion (o desplazamiento) esta en
+ * cel[1].param */
+bool ir_is_loop(const ir_node *n);
+
+/* celda de n con el desplazamiento respecto de fp de la local o
+ * argumento que usa (en su param), o -1 si no usa ninguno */
+int ir_arg_cell(const ir_node *n);
+
+/* devuelve un array (que hay que liberar con free()) con una
+ * entrada por nodo, mas una para el final, que dice si algun
+ * salto va a el: los nodos marcados empiezan un bloque basico. */
+bool *ir_jump_targets(const ir_func *f);
+
+/* ANALISIS */
+
+/* true si n calcula un valor (mete una sola celda) a partir solo
+ * de los que saca de la pila, de constantes o de una variable, sin
+ * efectos laterales: constpush, eval, argeval, los operadores,
+ * las conversiones y los builtins que no son impuros. */
+bool ir_is_pure(const ir_node *n);
+
+/* true si n, aun siendo puro, puede terminar con execerror()
+ * (division y modulo de cualquier tipo, potencia entera,
+ * instrucciones de los plugins).  No se puede ejecutar donde
+ * antes no se hacia. */
+bool ir_may_fail(const ir_node *n);
+
+/* tipo del valor que mete n en la pila, si es puro, o NULL */
+const type2inst *ir_result_t2i(const ir_node *n);
+
+/* primer nodo de la expresion pura cuyo valor mete el nodo end en
+ * la pila, o -1 si no la hay: algun nodo no es puro o algun salto
+ * (tgt, ver ir_jump_targets()) cae dentro de ella. */
+int ir_expr_start(const ir_func *f, const bool *tgt, int end);
+
+/* variables que se pueden modificar en un rango de codigo: las
+ * globales por su direccion (el param de assign/eval) y las
+ * locales/argumentos por su desplazamiento respecto de fp */
+typedef struct ir_clobber_s {
+    long       *gvars;
+    size_t      gvars_len,
+                gvars_cap;
+    long       *slots;
+    size_t      slots_len,
+                slots_cap;
+    bool        all_gvars;          /* no se sabe cuales: todas */
+} ir_clobber;
+
+/* a;ade a c lo que modifican los nodos [from, to) de f, incluidas
+ * las globales que modifican (directa o indirectamente) las
+ * subrutinas a las que se llama desde ellos. */
+void ir_clobber_range(const ir_func *f, int from, int to, ir_clobber *c);
+
+/* true si el valor que mete n (eval o argeval) puede cambiar por
+ * lo que hay en c */
+bool ir_clobbers(const ir_clobber *c, const ir_node *n);
+
+void ir_clobber_free(ir_clobber *c);
+
+/* MARCO DE PILA */
+
+/* celdas de variables locales que usa f por debajo de fp (las
+ * nuevas van a continuacion), o -1 si no tiene la forma esperada:
+ * enter ... leave_ret (o leave_ret_val) para las subrutinas y
+ * ... STOP para el codigo de nivel superior. */
+int ir_frame_size(const ir_func *f);
+
+/* hace que las celdas [fp - size, fp) queden reservadas durante
+ * toda la ejecucion de f: en las subrutinas, con el enter del
+ * preambulo, y en el nivel superior, a;adiendo un spadd a la
+ * entrada y otro a la salida (adonde van tambien los saltos que
+ * iban al final).  f debe tener la forma que comprueba
+ * ir_frame_size(). */
+void ir_frame_reserve(ir_func *f, int size);
+
+/* PASADAS (cada una en su modulo) */
+
+bool ir_pass_dce(ir_func *f);       /* dce.c */
+bool ir_pass_inline(ir_func *f);    /* inline.c */
+bool ir_pass_licm(ir_func *f);      /* licm.c */
+bool ir_pass_cse(ir_func *f);       /* cse.c */
+bool ir_pass_strength(ir_func *f);  /* strength.c */
+
+/* selecciona las pasadas a ejecutar (opcion -O): una lista de
+ * nombres separados por comas, "all" (por defecto) o "none".
+ * Devuelve -1 si algun nombre no existe. */
+int ir_select_passes(const char *spec);
+
+/* construye la IR de [start, end) (end debe ser progp), le aplica
+ * las pasadas seleccionadas y, si alguna ha cambiado algo,
+ * regenera el codigo, dejando progp en el nuevo final. */
+void ir_optimize(Symbol *subr, Cell *start, Cell *end);
+
+#endif /* IR_H_3f0b9d2e_d117_11f0_8c4a_0023ae68f329 */
@@ -0,0 +1,199 @@
+/* licm.c -- pasada de la IR que saca de los bucles las
+ * subexpresiones que no cambian dentro de ellos.
+ * License: BSD
+ *
+ * Un bucle while queda como
+ *
+ *   t:  cond...  if_f_goto  fin
+ *       cuerpo...
+ *   g:  Goto t
+ *   fin:
+ *
+ * y un for de la misma forma, con t al principio del cuerpo (la
+ * comprobacion de entrada queda delante) y el loop_inc_goto del
+ * final en g.
+ *
+ * Una subexpresion pura de [t, g] es invariante si solo lee
+ * globales y locales que no se asignan en el bucle (ni en las
+ * subrutinas a las que se llama desde el, ver
+ * ir_clobber_range()) y no puede fallar, ya que se va a
+ * calcular aunque el bucle no de ninguna vuelta.  Se calcula una
+ * vez antes de t, guardandola en una local temporal nueva, y en
+ * el bucle se sustituye por la lectura de esta.  Los saltos que
+ * llegaban a t desde fuera del bucle pasan a ir al calculo
+ * previo. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+
+#include "cellP.h"
+#include "dynarray.h"
+#include "instr.h"
+#include "ir.h"
+#include "types.h"
+
+#ifndef   UQ_LICM_MAX_TEMPS /* { */
+#warning  UQ_LICM_MAX_TEMPS should be defined in config.mk
+#define   UQ_LICM_MAX_TEMPS     (16)
+#endif /* UQ_LICM_MAX_TEMPS    } */
+
+#ifndef   UQ_IR_INCRMNT /* { */
+#warning  UQ_IR_INCRMNT should be defined in config.mk
+#define   UQ_IR_INCRMNT         (256)
+#endif /* UQ_IR_INCRMNT    } */
+
+/* nombre de las temporales en los listados */
+static const char tmp_name[] = "{LICM}";
+
+typedef struct loop_s {
+    int t, g;  /* primer nodo y Goto de vuelta */
+} loop;
+
+/* los bucles exteriores primero: lo que es invariante en ellos
+ * sale directamente fuera de todos */
+static int by_size(const void *a, const void *b)
+{
+    const loop *la = a, *lb = b;
+
+    return (lb->g - lb->t) - (la->g - la->t);
+} /* by_size */
+
+/* un bucle solo tiene una entrada, por t */
+static bool valid_loop(const ir_func *f, int t, int g)
+{
+    for (int i = 0; i < f->nodes_len; i++) {
+        int tg = f->nodes[i].target;
+
+        if ((i < t || i > g) && tg > t && tg <= g)
+            return false;
+    }
+    return true;
+} /* valid_loop */
+
+static bool invariant(
+        const ir_func    *f,
+        const ir_clobber *c,
+        int               s,
+        int               e)
+{
+    const type2inst *typ = ir_result_t2i(f->nodes + e);
+
+    if (typ == NULL || typ->argeval == NULL || typ->argassign == NULL)
+        return false;
+
+    for (int j = s; j <= e; j++) {
+        if (ir_may_fail(f->nodes + j) || ir_clobbers(c, f->nodes + j))
+            return false;
+    }
+    return true;
+} /* invariant */
+
+/* sustituye [s, e] por la lectura de la local -slot, y calcula
+ * [s, e] en ella antes de t */
+static void hoist(ir_func *f, int t, int g, int s, int e, int slot)
+{
+    const type2inst *typ  = ir_result_t2i(f->nodes + e);
+    int              len  = e - s + 1,
+                     lin  = f->nodes[s].lin,
+                     col  = f->nodes[s].col;
+    ir_node         *copy = malloc(len * sizeof *copy);
+
+    memcpy(copy, f->nodes + s, len * sizeof *copy);
+
+    ir_node *n = f->nodes + s;
+    *n = ir_make(typ->argeval->code_id, lin, col);
+    n->cel[0].param = -slot;
+    n->cel[1].str   = tmp_name;
+    for (int j = s + 1; j <= e; j++)
+        ir_delete(f, j);
+
+    int k = t;
+    for (int j = 0; j < len; j++)
+        ir_insert(f, k++, copy + j);
+    free(copy);
+
+    ir_node as = ir_make(typ->argassign->code_id, lin, col);
+    as.cel[0].param = -slot;
+    as.cel[1].str   = tmp_name;
+    ir_insert(f, k++, &as);
+
+    ir_node dr = ir_make(INST_drop, lin, col);
+    ir_insert(f, k++, &dr);
+
+    /* el bucle empieza ahora en k */
+    g += k - t;
+    for (int i = 0; i < f->nodes_len; i++) {
+        if ((i < t || i > g) && f->nodes[i].target == k)
+            f->nodes[i].target = t;
+    }
+} /* hoist */
+
+/* saca una subexpresion invariante de algun bucle de f a la
+ * local -slot.  Devuelve false si no encuentra ninguna. */
+static bool hoist_one(ir_func *f, int slot)
+{
+    bool   *tgt       = ir_jump_targets(f);
+    loop   *loops     = NULL;
+    size_t  loops_len = 0,
+            loops_cap = 0;
+    bool    done      = false;
+
+    for (int g = 0; g < f->nodes_len; g++) {
+        int t = f->nodes[g].target;
+
+        if ((f->nodes[g].op == INST_Goto || ir_is_loop(f->nodes + g))
+                && t >= 0 && t < g
+                && valid_loop(f, t, g))
+        {
+            DYNARRAY_GROW(loops, loop, 1, UQ_IR_INCRMNT);
+            loops[loops_len++] = (loop){ .t = t, .g = g };
+        }
+    }
+    qsort(loops, loops_len, sizeof *loops, by_size);
+
+    for (size_t l = 0; l < loops_len && !done; l++) {
+        int        t = loops[l].t,
+                   g = loops[l].g;
+        ir_clobber c = { 0 };
+
+        ir_clobber_range(f, t, g + 1, &c);
+
+        /* de atras adelante, la primera que se encuentra es la
+         * mayor que la contiene */
+        for (int e = g; e > t; e--) {
+            int s = ir_expr_start(f, tgt, e);
+
+            if (s >= t && s < e && invariant(f, &c, s, e)) {
+                hoist(f, t, g, s, e, slot);
+                done = true;
+                break;
+            }
+        }
+        ir_clobber_free(&c);
+    }
+    free(loops);
+    free(tgt);
+
+    return done;
+} /* hoist_one */
+
+bool ir_pass_licm(ir_func *f)
+{
+    int size  = ir_frame_size(f),
+        temps = 0;
+
+    if (size < 0)
+        return false;
+
+    while (temps < UQ_LICM_MAX_TEMPS && hoist_one(f, size + temps + 1)) {
+        temps++;
+        ir_compact(f);
+    }
+    if (temps > 0)
+        ir_frame_reserve(f, size + temps);
+
+    return temps > 0;
+} /* ir_pass_licm */
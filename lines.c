@@ -0,0 +1,185 @@
+/* lines.c -- tabla de correspondencia entre direcciones de
+ * prog[] y posiciones (linea, columna) del fuente.
+ * License: BSD
+ *
+ * La tabla es un flujo de bytes con una entrada por cada
+ * cambio de posicion en el fuente.  Cada entrada son tres
+ * enteros codificados en base 128 (7 bits por byte, el bit
+ * alto indica que siguen mas bytes):
+ *
+ *   direccion - direccion anterior     (siempre > 0)
+ *   linea - linea anterior             (zigzag, con signo)
+ *   columna - columna anterior         (zigzag, con signo)
+ *
+ * de forma que un programa tipico ocupa unos 3 bytes por linea
+ * de codigo.  Cada UQ_LINES_CHECKPOINT bytes se guarda un
+ * punto de control con el estado del decodificador, para que
+ * las busquedas (y los truncados, cuando se reescribe el codigo
+ * de nivel superior) no tengan que decodificar toda la tabla. */
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "config.h"
+#include "dynarray.h"
+#include "lines.h"
+
+#ifndef   UQ_LINES_INCRMNT /* { */
+#warning  UQ_LINES_INCRMNT should be defined in config.mk
+#define   UQ_LINES_INCRMNT      (1024)
+#endif /* UQ_LINES_INCRMNT    } */
+
+#ifndef   UQ_LINES_CHECKPOINT /* { */
+#warning  UQ_LINES_CHECKPOINT should be defined in config.mk
+#define   UQ_LINES_CHECKPOINT   (128)
+#endif /* UQ_LINES_CHECKPOINT    } */
+
+/* estado del decodificador: la ultima entrada leida */
+typedef struct lines_state_s {
+    size_t off;     /* posicion de la siguiente entrada en table[] */
+    long   addr;
+    int    lin,
+           col;
+} lines_state;
+
+static const lines_state initial = { .addr = -1 };
+
+static unsigned char *table;        /* flujo de entradas */
+static size_t         table_len,
+                      table_cap;
+
+static lines_state   *checkpoints;  /* estado antes de cada punto */
+static size_t         checkpoints_len,
+                      checkpoints_cap;
+
+static lines_state    last = { .addr = -1 }; /* ultima entrada */
+static long           top_addr = -1; /* ultima direccion anotada */
+
+static void put_varint(unsigned long val)
+{
+    do {
+        DYNARRAY_GROW(table, unsigned char, 1, UQ_LINES_INCRMNT);
+        table[table_len++] = (val & 0x7f) | (val > 0x7f ? 0x80 : 0);
+        val >>= 7;
+    } while (val);
+} /* put_varint */
+
+static unsigned long get_varint(size_t *off)
+{
+    unsigned long val   = 0;
+    int           shift = 0;
+    unsigned char c;
+
+    do {
+        c      = table[(*off)++];
+        val   |= (unsigned long)(c & 0x7f) << shift;
+        shift += 7;
+    } while (c & 0x80);
+
+    return val;
+} /* get_varint */
+
+#define ZIGZAG(_v)   (((unsigned long)(_v) << 1) ^ ((_v) < 0 ? ~0UL : 0UL))
+#define UNZIGZAG(_u) ((long)((_u) >> 1) ^ -(long)((_u) & 1))
+
+/* decodifica la entrada siguiente a st */
+static void next(lines_state *st)
+{
+    st->addr += get_varint(&st->off);
+    unsigned long dl = get_varint(&st->off),
+                  dc = get_varint(&st->off);
+    st->lin  += UNZIGZAG(dl);
+    st->col  += UNZIGZAG(dc);
+} /* next */
+
+void lines_record(long addr, int lin, int col)
+{
+    if (addr <= top_addr)
+        return;   /* codigo parcheado, ya anotado */
+    top_addr = addr;
+
+    if (lin == last.lin && col == last.col && last.addr >= 0)
+        return;   /* misma posicion que la entrada anterior */
+
+    if (checkpoints_len == 0
+            || table_len - checkpoints[checkpoints_len - 1].off
+                >= UQ_LINES_CHECKPOINT)
+    {
+        DYNARRAY_GROW(checkpoints, lines_state, 1, UQ_LINES_INCRMNT);
+        checkpoints[checkpoints_len++] = last;
+    }
+    put_varint(addr - last.addr);
+    put_varint(ZIGZAG((long) lin - last.lin));
+    put_varint(ZIGZAG((long) col - last.col));
+
+    last.addr = addr;
+    last.lin  = lin;
+    last.col  = col;
+    last.off  = table_len;
+} /* lines_record */
+
+/* devuelve el estado del ultimo punto de control anterior a addr */
+static lines_state find_checkpoint(long addr)
+{
+    size_t lo = 0, hi = checkpoints_len;
+
+    /* primer punto de control con addr >= addr */
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (checkpoints[mid].addr < addr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo > 0 ? checkpoints[lo - 1] : initial;
+} /* find_checkpoint */
+
+int lines_lookup(long addr, int *lin, int *col)
+{
+    if (addr < 0 || addr > top_addr)
+        return 0;
+
+    lines_state st = find_checkpoint(addr + 1);
+
+    while (st.off < table_len) {
+        lines_state nxt = st;
+        next(&nxt);
+        if (nxt.addr > addr)
+            break;
+        st = nxt;
+    }
+    if (st.addr < 0)
+        return 0;
+
+    *lin = st.lin;
+    *col = st.col;
+    return 1;
+} /* lines_lookup */
+
+void lines_truncate(long addr)
+{
+    if (addr > top_addr)
+        return;
+
+    lines_state st = find_checkpoint(addr);
+
+    while (st.off < table_len) {
+        lines_state nxt = st;
+        next(&nxt);
+        if (nxt.addr >= addr)
+            break;
+        st = nxt;
+    }
+    table_len = st.off;
+    last      = st;
+    top_addr  = addr - 1;
+
+    while (checkpoints_len > 0
+            && checkpoints[checkpoints_len - 1].off >= table_len)
+        checkpoints_len--;
+} /* lines_truncate */
+
+size_t lines_size(void)
+{
+    return table_len;
+} /* lines_size */
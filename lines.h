@@ -0,0 +1,27 @@
+/* lines.h -- tabla de correspondencia entre direcciones de
+ * prog[] y posiciones (linea, columna) del fuente.
+ * License: BSD
+ */
+#ifndef LINES_H_a8f2d6b0_cd1e_11f0_9c57_0023ae68f329
+#define LINES_H_a8f2d6b0_cd1e_11f0_9c57_0023ae68f329
+
+#include <stddef.h>
+
+/* anota que la instruccion en la direccion addr (indice en
+ * prog[]) procede de la posicion lin:col del fuente.  Las
+ * direcciones que no superan la ultima anotada (p.ej. al
+ * parchear codigo ya generado) se ignoran. */
+void lines_record(long addr, int lin, int col);
+
+/* elimina las anotaciones de las direcciones >= addr, cuando
+ * el codigo a partir de addr se va a regenerar. */
+void lines_truncate(long addr);
+
+/* busca la posicion del fuente de la direccion addr.
+ * Devuelve 0 si no hay anotacion para ella. */
+int lines_lookup(long addr, int *lin, int *col);
+
+/* tama;o en bytes de la tabla codificada */
+size_t lines_size(void);
+
+#endif /* LINES_H_a8f2d6b0_cd1e_11f0_9c57_0023ae68f329 */
@@ -8,7 +8,6 @@
 
 #include <assert.h>
 #include <fcntl.h>
-#include <dlfcn.h>
 #include <dirent.h>
 #include <getopt.h>
 #include <errno.h>
@@ -24,6 +23,14 @@
 #include "hoc.h"
 #include "code.h"
 #include "init.h"
+#include "ir.h"
+#include "plugin_cache.h"
+#include "profile.h"
+#include "budget.h"
+#include "sample.h"
+#include "stack.h"
+#include "stats.h"
+#include "trace.h"
 
 #ifndef   HOC_PLUGINS_PATH_VAR /* { */
 #warning  HOC_PLUGINS_PATH_VAR should be defined in config.mk
@@ -35,6 +42,11 @@
 #define   DEFAULT_HOC_PLUGINS_PATH pkgactivepluginsdir
 #endif /* DEFAULT_HOC_PLUGINS_PATH    } */
 
+#ifndef   UQ_STACK_SIZE /* { */
+#warning  UQ_STACK_SIZE should be defined in config.mk
+#define   UQ_STACK_SIZE         (1048576)
+#endif /* UQ_STACK_SIZE    } */
+
 #ifndef   UQ_CODE_DEBUG_EXEC /* { */
 #warning  UQ_CODE_DEBUG_EXEC deberia ser configurado en config.mk
 #define   UQ_CODE_DEBUG_EXEC  0
@@ -65,22 +77,82 @@ void do_help(int exit_code)
     printf(
         "Uso: %s [ opts ] [ file ... ]\n"
         "Where opts are:\n"
-        "  -h  this help screen\n",
-        progname);
+        "  -h  this help screen\n"
+        "  -I n  abort each statement after n instructions\n"
+        "  -O passes  optimization passes to run: a comma separated\n"
+        "      list of pass names, all (default) or none\n"
+        "  -p  profile execution, print a report at exit\n"
+        "  -P file  sample execution, write folded stacks to file\n"
+        "  -s  print execution statistics at exit\n"
+        "  -S cells  size of the execution stack, with an optional\n"
+        "      k or M suffix (default %d)\n"
+        "  -T secs  abort each statement after secs seconds\n"
+        "  -t spec  write a binary execution trace.  spec is a comma\n"
+        "      separated list of func=NAME, addr=LO-HI (hex), after=N\n"
+        "      and file=PATH\n"
+        "  -v  print version and configuration\n",
+        progname, UQ_STACK_SIZE);
     exit(exit_code);
 } /* do_help */
 
 static void process(FILE *in);
 void init_plugins(void);
 
+/* -S cells: admite los sufijos k y M (x1024 y x1048576) */
+static size_t parse_stack_size(const char *arg)
+{
+    char          *end;
+    unsigned long  val = strtoul(arg, &end, 10);
+
+    switch (*end) {
+    case 'k': case 'K': val <<= 10; end++; break;
+    case 'm': case 'M': val <<= 20; end++; break;
+    }
+    if (*end != '\0' || val == 0) {
+        fprintf(stderr, "-S: invalid stack size '%s'\n", arg);
+        exit(EXIT_FAILURE);
+    }
+    return val;
+} /* parse_stack_size */
+
+/* -I n, -T secs */
+static double parse_limit(int opt, const char *arg)
+{
+    char   *end;
+    double  val = strtod(arg, &end);
+
+    if (*end != '\0' || val <= 0.0) {
+        fprintf(stderr, "-%c: invalid limit '%s'\n", opt, arg);
+        exit(EXIT_FAILURE);
+    }
+    return val;
+} /* parse_limit */
+
 int main(int argc, char *argv[]) /* hoc1 */
 {
     progname = argv[0];
     setbuf(stdout, NULL);
     int opt;
-    while ((opt = getopt(argc, argv, "hv")) != EOF) {
+    unsigned long max_insts = 0;
+    double        max_secs  = 0.0;
+    while ((opt = getopt(argc, argv, "hI:O:pP:sS:T:t:v")) != EOF) {
         switch (opt) {
         case 'h': do_help(EXIT_SUCCESS);
+        case 'I': max_insts = parse_limit(opt, optarg);
+                  budget_set(max_insts, max_secs); break;
+        case 'O': if (ir_select_passes(optarg) < 0) {
+                      fprintf(stderr, "-O: unknown pass in '%s'\n",
+                              optarg);
+                      exit(EXIT_FAILURE);
+                  }
+                  break;
+        case 'p': prof_init(); break;
+        case 'P': sample_init(optarg); break;
+        case 's': stats_init(); break;
+        case 'S': stack_init(parse_stack_size(optarg)); break;
+        case 'T': max_secs = parse_limit(opt, optarg);
+                  budget_set(max_insts, max_secs); break;
+        case 't': trace_init(optarg); break;
         case 'v': do_version(EXIT_SUCCESS);
         }
     } /* while */
@@ -118,6 +190,8 @@ int main(int argc, char *argv[]) /* hoc1 */
 static void process(FILE *in)
 {
     setjmp(begin);
+    if (sample_enabled)
+        sample_end(); /* por si execerror() abandono execute() */
     for (initcode(); parse(); initcode()) {
         /* EDW: Mon Sep  8 11:35:06 -05 2025
          *
@@ -127,6 +201,7 @@ static void process(FILE *in)
          * initcode() inicializa progp para preparar la memoria
          * para generar codigo.
          */
+        ir_optimize(NULL, progbase, progp);
         initexec();
         execute(progbase);
         EXEC("Stack size after execution: %d\n", stacksize());
@@ -154,6 +229,8 @@ void init_plugins(void)
 
     plugin_dirs = strdup(plugin_dirs);
 
+    plugin_cache_open();
+
     for (   const char *plugins_dir_name = strtok(plugin_dirs, ":\n");
             plugins_dir_name != NULL;
             plugins_dir_name = strtok(NULL, ":\n"))
@@ -180,16 +257,16 @@ void init_plugins(void)
             snprintf(plugin_name, sizeof plugin_name,
                      "%s/%s", plugins_dir_name, file->d_name);
 
-            void *plugin_so = dlopen(plugin_name, RTLD_LAZY);
-            if (plugin_so == NULL) {
-                fprintf(stderr, "dlopen %s: %s\n",
-                    plugin_name,
-                    dlerror());
-            }
+            /* el plugin solo se carga aqui si no esta en el
+             * manifiesto, en otro caso se carga la primera vez
+             * que se use uno de sus builtins. */
+            plugin_cache_add(plugin_name);
         } /* while */
 
         /* close dir and go to next */
         closedir(dir);
     } /* for */
     free(plugin_dirs);
+
+    plugin_cache_close();
 } /* init_plugins */
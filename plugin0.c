@@ -9,36 +9,37 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/time.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 #include "plugins.h"
+#include "colors.h"
 
 /* ONE PARAMETER FUNCTIONS */
 
-/* this macro expands to a generic builtin call of
- * one parameter (of any type, expressed by the _rfld
- * macro parameter) and one result (of the same type)
- * and calls the function internally, extracting the
- * parameter from the hoc stack, and pushing in the
- * stack the result value.
+/* this macro expands to a native function of one double
+ * parameter returning double, that is called directly by
+ * the bltin_dd instruction (the parameter is read from the
+ * hoc stack by the instruction itself, and the result is
+ * stored in the same place, without calling pop()/push()),
+ * and the const callback used to evaluate it in constant
+ * expressions.
  * Example:
- * DOUBLE_F(dbl, sin, sin) -->
- * void sin_cb(int plugin_id)
+ * DOUBLE_F(inv, 1.0/) -->
+ * static double inv_d_d(double x)
  * {
- *     Cell par = pop();
- *     Cell result = { .dbl = sin(par.dbl) };  <-- result is calculated here
- *     push(result);
- * } / * sin_cb * /
+ *     return 1.0/(x);  <-- result is calculated here
+ * } / * inv_d_d * /
  */
 #define DOUBLE_F( /*                     { */      \
-        _rfld, /* result field */                  \
         _name, /* builtin name */                  \
         _func) /* funct to call */                 \
-void _name##_cb(int plugin_id)                     \
+static double _name##_d_d(double x)                \
 {                                                  \
-    Cell   par    = pop();                         \
-    Cell   result = { ._rfld = _func(par._rfld) }; \
-    push(result);                                  \
-} /* _name##_cb                          }{ */     \
+    return _func(x);                               \
+} /* _name##_d_d                         }{ */     \
                                                    \
 ConstExpr                                          \
 _name##_const_cb(                                  \
@@ -47,44 +48,42 @@ _name##_const_cb(                                  \
 {                                                  \
     ConstExpr result = {                           \
         .typ   = Double,                           \
-        .cel   = { ._rfld =                        \
-            _func(args->expr_list[0].cel._rfld) }, \
+        .cel   = { .dbl = _name##_d_d(             \
+                args->expr_list[0].cel.dbl) },     \
     };                                             \
     return result;                                 \
 } /* _name##_const_cb                    }{ */     \
 
-DOUBLE_F(dbl, abs,   fabs)
-DOUBLE_F(dbl, acos,  acos)
-DOUBLE_F(dbl, acosh, acosh)
-DOUBLE_F(dbl, asin,  asin)
-DOUBLE_F(dbl, asinh, asinh)
-DOUBLE_F(dbl, atan,  atan)
-DOUBLE_F(dbl, atanh, atanh)
-DOUBLE_F(dbl, cos,   cos)
-DOUBLE_F(dbl, cosh,  cosh)
-DOUBLE_F(dbl, exp,   exp)
-DOUBLE_F(dbl, inv,   1.0/)
-DOUBLE_F(dbl, log,   log)
-DOUBLE_F(dbl, log10, log10)
-DOUBLE_F(dbl, ops,   - )
-DOUBLE_F(dbl, sin,  sin)
-DOUBLE_F(dbl, sinh, sinh)
-DOUBLE_F(dbl, sqrt, sqrt)
-DOUBLE_F(dbl, tan,  tan)
-DOUBLE_F(dbl, tanh, tanh)
+DOUBLE_F(abs,   fabs)
+DOUBLE_F(acos,  acos)
+DOUBLE_F(acosh, acosh)
+DOUBLE_F(asin,  asin)
+DOUBLE_F(asinh, asinh)
+DOUBLE_F(atan,  atan)
+DOUBLE_F(atanh, atanh)
+DOUBLE_F(cos,   cos)
+DOUBLE_F(cosh,  cosh)
+DOUBLE_F(exp,   exp)
+DOUBLE_F(inv,   1.0/)
+DOUBLE_F(log,   log)
+DOUBLE_F(log10, log10)
+DOUBLE_F(ops,   - )
+DOUBLE_F(sin,   sin)
+DOUBLE_F(sinh,  sinh)
+DOUBLE_F(sqrt,  sqrt)
+DOUBLE_F(tan,   tan)
+DOUBLE_F(tanh,  tanh)
 
 #undef DOUBLE_F /*                       } */
 
 /* TWO PARAMETER FUNCTIONS */
-#define DOUBLE_F2(_name, _expr) /*       { */\
-void _name##_cb(int plugin_id)              \
+/* the first parameter of the native function is the first
+ * parameter of the builtin, as declared in _init() below. */
+#define DOUBLE_F2(_name) /*              { */\
+static double _name##_d_dd(double x, double y) \
 {                                           \
-    double    x = pop().dbl,                \
-              y = pop().dbl;                \
-    Cell result = { .dbl  = _name _expr };  \
-                                            \
-    push(result); /*                     }{ */\
-} /* _name##_cb */                          \
+    return _name(x, y);                     \
+} /* _name##_d_dd                        }{ */\
                                             \
 ConstExpr                                   \
 _name##_const_cb(                           \
@@ -95,15 +94,15 @@ _name##_const_cb(                           \
            y = args->expr_list[1].cel.dbl;  \
     ConstExpr result = {                    \
         .typ = Double,                      \
-        .cel = { .dbl  = _name _expr },     \
+        .cel = { .dbl  = _name(x, y) },     \
     };                                      \
                                             \
     return result; /*                    }{ */\
 } /* _name##_const_cb */                    \
 
-DOUBLE_F2(atan2, (y, x))
-DOUBLE_F2(pow,   (x, y))
-DOUBLE_F2(fmod,  (y, x))
+DOUBLE_F2(atan2)
+DOUBLE_F2(pow)
+DOUBLE_F2(fmod)
 
 #undef DOUBLE_F2 /*                      } */
 
@@ -131,6 +130,130 @@ void srandom_cb(int plugin_id)
     srandom(pop().itg);
 }
 
+/* INLINE FUNCTIONS */
+
+/* estos builtins no se llaman a traves de bltin, sino que se
+ * registran como instrucciones nuevas de la maquina virtual,
+ * que code_bltin() inserta directamente en el codigo.  Los
+ * parametros estan en la pila (el ultimo en sp[0]) y el
+ * resultado sustituye al primero. */
+static void inline_prt(const instr *i, const Cell *pc)
+{
+    printf(YELLOW"%04lx" WHITE ": "
+        "<" CYAN "%02x" WHITE "> "
+        CYAN"%-14s"ANSI_END "\n",
+        pc - prog, i->code_id, i->name);
+} /* inline_prt */
+
+static double clamp(double x, double lo, double hi)
+{
+    return x < lo ? lo
+         : x > hi ? hi
+         : x;
+} /* clamp */
+
+static double scale_add(double a, double x, double b)
+{
+    return a * x + b;
+} /* scale_add */
+
+#define INLINE_F3(_name) /*              { */\
+static void _name##_exec(const instr *i)    \
+{                                           \
+    sp[2].dbl = _name(sp[2].dbl,            \
+                      sp[1].dbl,            \
+                      sp[0].dbl);           \
+    sp += 2;                                \
+    pc += i->n_cells;                       \
+} /* _name##_exec                        }{ */\
+                                            \
+static ConstExpr                            \
+_name##_const_eval(                         \
+        const instr        *i,              \
+        const ConstArglist *args)           \
+{                                           \
+    ConstExpr result = {                    \
+        .typ = Double,                      \
+        .cel = { .dbl  = _name(             \
+                args->expr_list[0].cel.dbl, \
+                args->expr_list[1].cel.dbl, \
+                args->expr_list[2].cel.dbl) }, \
+    };                                      \
+    return result;                          \
+} /* _name##_const_eval                  }{ */\
+                                            \
+static const instr _name##_instr = {        \
+    .name       = #_name,                   \
+    .n_cells    = 1,                        \
+    .exec       = _name##_exec,             \
+    .print      = inline_prt,               \
+    .prog       = arg_prog,                 \
+    .stk_pop    = 3,                        \
+    .stk_push   = 1,                        \
+    .const_eval = _name##_const_eval,       \
+}; /*                                    } */
+
+INLINE_F3(clamp)
+INLINE_F3(scale_add)
+
+#undef INLINE_F3
+
+/* relojes para medir fases de un script desde el propio hoc.
+ * Son instrucciones, no llamadas a bltin, para que medir un
+ * bucle cueste lo menos posible.  No tienen const_eval, pues
+ * no pueden evaluarse en tiempo de compilacion. */
+static long clock_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+} /* clock_ns */
+
+static long cputime_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+} /* cputime_ns */
+
+/* contador de ciclos del procesador (o de ticks del contador
+ * virtual en aarch64).  Donde no hay ninguno, nanosegundos. */
+static long cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    long val;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r" (val));
+    return val;
+#else
+    return clock_ns();
+#endif
+} /* cycles */
+
+#define INLINE_L0(_name) /*              { */\
+static void _name##_exec(const instr *i)    \
+{                                           \
+    push((Cell){ .lng = _name() });         \
+    pc += i->n_cells;                       \
+} /* _name##_exec                        }{ */\
+                                            \
+static const instr _name##_instr = {        \
+    .name       = #_name,                   \
+    .n_cells    = 1,                        \
+    .exec       = _name##_exec,             \
+    .print      = inline_prt,               \
+    .prog       = arg_prog,                 \
+    .stk_pop    = 0,                        \
+    .stk_push   = 1,                        \
+}; /*                                    } */
+
+INLINE_L0(clock_ns)
+INLINE_L0(cputime_ns)
+INLINE_L0(cycles)
+
+#undef INLINE_L0
+
 /* La rutina que dlopen() ejecuta automaticamente se llama
  * _init, pero es necesario enlazar el .so llamando al
  * linker ld(1) directamente, para que no cargue el modulo
@@ -148,6 +271,18 @@ int _init()
                       ##__VA_ARGS__,            \
                       NULL, NULL)
 
+#define REGISTER_D_D(_name, _par)               \
+    register_builtin_d_d(#_name,                \
+                      _name##_d_d,              \
+                      _name##_const_cb,         \
+                      _par)
+
+#define REGISTER_D_DD(_name, _par1, _par2)      \
+    register_builtin_d_dd(#_name,               \
+                      _name##_d_dd,             \
+                      _name##_const_cb,         \
+                      _par1, _par2)
+
 /* these callbacks (expanded from macro above) don't exist,
  * so we define them as the constant NULL to make register
  * not to register the const_ callback. */
@@ -156,32 +291,58 @@ int _init()
 #define time_const_cb    NULL
 #define exit_const_cb    NULL
 
-    REGISTER_BUILTIN(Double,  abs,   "x", Double);
-    REGISTER_BUILTIN(Double,  acos,  "x", Double);
-    REGISTER_BUILTIN(Double,  acosh, "x", Double);
-    REGISTER_BUILTIN(Double,  asin,  "x", Double);
-    REGISTER_BUILTIN(Double,  asinh, "x", Double);
-    REGISTER_BUILTIN(Double,  atan,  "x", Double);
-    REGISTER_BUILTIN(Double,  atan2, "y", Double, "x", Double);
-    REGISTER_BUILTIN(Double,  atanh, "x", Double);
-    REGISTER_BUILTIN(Double,  cos,   "x", Double);
-    REGISTER_BUILTIN(Double,  cosh,  "x", Double);
-    REGISTER_BUILTIN(Double,  exp,   "x", Double);
-    REGISTER_BUILTIN(Double,  inv,   "x", Double);
-    REGISTER_BUILTIN(Double,  log,   "x", Double);
-    REGISTER_BUILTIN(Double,  log10, "x", Double);
-    REGISTER_BUILTIN(Double,  fmod,  "y", Double, "x", Double);
-    REGISTER_BUILTIN(Double,  ops,   "x", Double);
-    REGISTER_BUILTIN(Double,  pow,   "x", Double, "y", Double);
-    REGISTER_BUILTIN(Long,    random);
-    REGISTER_BUILTIN(Double,  sin,   "x", Double);
-    REGISTER_BUILTIN(Double,  sinh,  "x", Double);
-    REGISTER_BUILTIN(Double,  sqrt,  "x", Double);
-    REGISTER_BUILTIN(NULL,    srandom, "x", Integer);
-    REGISTER_BUILTIN(Double,  tan,   "x", Double);
-    REGISTER_BUILTIN(Double,  tanh,  "x", Double);
-    REGISTER_BUILTIN(Long,    time);
-    REGISTER_BUILTIN(NULL,    exit,  "x", Integer);
+/* los builtins con parametros constantes y callback constante
+ * se evaluan al compilar (ver builtin_is_foldable()).  Los que
+ * dependen del reloj o de un estado, o tienen efectos laterales,
+ * se marcan como impuros para que eso no ocurra nunca, aunque
+ * alguien les a;ada un callback constante. */
+
+    REGISTER_D_D (abs,   "x");
+    REGISTER_D_D (acos,  "x");
+    REGISTER_D_D (acosh, "x");
+    REGISTER_D_D (asin,  "x");
+    REGISTER_D_D (asinh, "x");
+    REGISTER_D_D (atan,  "x");
+    REGISTER_D_DD(atan2, "y", "x");
+    REGISTER_D_D (atanh, "x");
+    REGISTER_D_D (cos,   "x");
+    REGISTER_D_D (cosh,  "x");
+    REGISTER_D_D (exp,   "x");
+    REGISTER_D_D (inv,   "x");
+    REGISTER_D_D (log,   "x");
+    REGISTER_D_D (log10, "x");
+    REGISTER_D_DD(fmod,  "y", "x");
+    REGISTER_D_D (ops,   "x");
+    REGISTER_D_DD(pow,   "x", "y");
+    builtin_set_impure(REGISTER_BUILTIN(Long,    random));
+    REGISTER_D_D (sin,   "x");
+    REGISTER_D_D (sinh,  "x");
+    REGISTER_D_D (sqrt,  "x");
+    builtin_set_impure(REGISTER_BUILTIN(NULL,    srandom, "x", Integer));
+    REGISTER_D_D (tan,   "x");
+    REGISTER_D_D (tanh,  "x");
+    builtin_set_impure(REGISTER_BUILTIN(Long,    time));
+    builtin_set_impure(REGISTER_BUILTIN(NULL,    exit,  "x", Integer));
+
+#define REGISTER_INLINE(_name, _par1, _par2, _par3)  \
+    register_builtin_inline(#_name, Double,           \
+                      register_instruction(&_name##_instr), \
+                      _par1, Double,                  \
+                      _par2, Double,                  \
+                      _par3, Double,                  \
+                      NULL)
+
+    REGISTER_INLINE(clamp,     "x", "lo", "hi");
+    REGISTER_INLINE(scale_add, "a", "x",  "b");
+
+#define REGISTER_INLINE_L0(_name)                    \
+    register_builtin_inline(#_name, Long,             \
+                      register_instruction(&_name##_instr), \
+                      NULL)
+
+    builtin_set_impure(REGISTER_INLINE_L0(clock_ns));
+    builtin_set_impure(REGISTER_INLINE_L0(cputime_ns));
+    builtin_set_impure(REGISTER_INLINE_L0(cycles));
 
     return 0;
 } /* _init() */
@@ -0,0 +1,420 @@
+/* plugin_cache.c -- carga perezosa de plugins a traves de un
+ * manifiesto cacheado de los builtins que define cada plugin.
+ * License: BSD
+ *
+ * El manifiesto es un fichero de texto con el formato:
+ *
+ *   # comentario
+ *   plugin <mtime> <size> <path del .so>
+ *   builtin <kind> <nombre> <tipo|-> [<param> <tipo>]...
+ *   ...
+ *
+ * donde <kind> es "stack", "d_d", "d_dd" o "inline" (ver
+ * bltin_kind en builtinsP.h) y los tipos se dan por nombre.  Las lineas
+ * builtin se refieren al ultimo plugin listado.  Si el mtime o
+ * el tama;o del .so no coinciden con los del manifiesto, el
+ * plugin se carga al arrancar (como se hacia antes) y se
+ * reescribe el manifiesto con los builtins que registra.
+ * Un plugin que no registra ningun builtin (p.ej.
+ * plugin_edw_welcome.so) se carga siempre al arrancar, pues
+ * solo tiene efecto en su _init(). */
+
+#include <assert.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "colors.h"
+#include "dynarray.h"
+#include "error.h"
+#include "hoc.h"
+#include "intern.h"
+#include "scope.h"
+#include "symbolP.h"
+#include "builtinsP.h"
+#include "plugin_cache.h"
+
+#ifndef   HOC_PLUGINS_CACHE_VAR /* { */
+#warning  HOC_PLUGINS_CACHE_VAR should be defined in config.mk
+#define   HOC_PLUGINS_CACHE_VAR "HOC_PLUGINS_CACHE"
+#endif /* HOC_PLUGINS_CACHE_VAR    } */
+
+#ifndef   DEFAULT_HOC_PLUGINS_CACHE /* { */
+#warning  DEFAULT_HOC_PLUGINS_CACHE should be defined in config.mk
+#define   DEFAULT_HOC_PLUGINS_CACHE ".cache/hoc/plugins.manifest"
+#endif /* DEFAULT_HOC_PLUGINS_CACHE    } */
+
+#ifndef   UQ_PLUGINS_INCRMNT /* { */
+#warning  UQ_PLUGINS_INCRMNT should be defined in config.mk
+#define   UQ_PLUGINS_INCRMNT        (8)
+#endif /* UQ_PLUGINS_INCRMNT    } */
+
+#ifndef   UQ_PLUGINS_MAX_PARAMS /* { */
+#warning  UQ_PLUGINS_MAX_PARAMS should be defined in config.mk
+#define   UQ_PLUGINS_MAX_PARAMS     (16)
+#endif /* UQ_PLUGINS_MAX_PARAMS    } */
+
+typedef struct plugin_s {
+    const char     *path;      /* nombre del .so (interned) */
+    time_t          mtime;
+    off_t           size;
+    void           *handle;    /* NULL mientras no se cargue */
+} plugin;
+
+typedef struct manifest_entry_s {
+    const char     *path;
+    time_t          mtime;
+    off_t           size;
+    char          **lines;     /* lineas builtin de este plugin */
+    size_t          lines_len,
+                    lines_cap;
+    bool            used;
+} manifest_entry;
+
+typedef struct stub_s {
+    const char     *name;
+    const Symbol   *type;
+    bltin_kind      kind;
+    int             n_params;
+    const char     *par_names[UQ_PLUGINS_MAX_PARAMS];
+    const Symbol   *par_types[UQ_PLUGINS_MAX_PARAMS];
+} stub;
+
+static plugin         *plugins;
+static size_t          plugins_len,
+                       plugins_cap;
+
+static manifest_entry *entries;
+static size_t          entries_len,
+                       entries_cap;
+
+static char           *manifest_name;  /* NULL si no hay cache */
+static bool            manifest_dirty;
+
+static const char *kind_names[] = {
+    [BLTIN_KIND_STACK]  = "stack",
+    [BLTIN_KIND_D_D]    = "d_d",
+    [BLTIN_KIND_D_DD]   = "d_dd",
+    [BLTIN_KIND_INLINE] = "inline",
+};
+
+static char *
+get_manifest_name(void)
+{
+    const char *name = getenv(HOC_PLUGINS_CACHE_VAR);
+
+    if (name != NULL) { /* vacio deshabilita la cache */
+        return name[0] ? strdup(name) : NULL;
+    }
+
+    const char *home = getenv("HOME");
+    if (home == NULL)
+        return NULL;
+
+    char buffer[1024];
+    snprintf(buffer, sizeof buffer,
+             "%s/%s", home, DEFAULT_HOC_PLUGINS_CACHE);
+
+    return strdup(buffer);
+} /* get_manifest_name */
+
+void
+plugin_cache_open(void)
+{
+    manifest_name = get_manifest_name();
+    if (manifest_name == NULL)
+        return;
+
+    FILE *f = fopen(manifest_name, "r");
+    if (f == NULL) {
+        manifest_dirty = true;
+        return;
+    }
+
+    char            line[1024];
+    manifest_entry *cur = NULL;
+
+    while (fgets(line, sizeof line, f)) {
+        line[strcspn(line, "\n")] = '\0';
+
+        if (line[0] == '#' || line[0] == '\0')
+            continue;
+
+        if (strncmp(line, "plugin ", 7) == 0) {
+            long long mtime, size;
+            int       n = 0;
+
+            cur = NULL;
+            if (sscanf(line + 7, "%lld %lld %n",
+                        &mtime, &size, &n) < 2 || n == 0)
+                continue;
+
+            DYNARRAY_GROW(entries, manifest_entry,
+                          1, UQ_PLUGINS_INCRMNT);
+            cur = entries + entries_len++;
+            memset(cur, 0, sizeof *cur);
+
+            cur->path  = intern(line + 7 + n);
+            cur->mtime = mtime;
+            cur->size  = size;
+        } else if (cur != NULL && strncmp(line, "builtin ", 8) == 0) {
+            DYNARRAY_GROW(cur->lines, char *,
+                          1, UQ_PLUGINS_INCRMNT);
+            cur->lines[cur->lines_len++] = strdup(line + 8);
+        }
+    } /* while */
+    fclose(f);
+} /* plugin_cache_open */
+
+static const Symbol *
+lookup_type_name(const char *name)
+{
+    const Symbol *sym = lookup(name);
+
+    return sym != NULL && sym->type == TYPE
+        ? sym
+        : NULL;
+} /* lookup_type_name */
+
+static bool
+parse_stub(const char *line, stub *out)
+{
+    char  buffer[1024],
+         *save;
+
+    strncpy(buffer, line, sizeof buffer - 1);
+    buffer[sizeof buffer - 1] = '\0';
+
+    const char *kind_s = strtok_r(buffer, " ", &save),
+               *name   = strtok_r(NULL,   " ", &save),
+               *type_s = strtok_r(NULL,   " ", &save);
+
+    if (kind_s == NULL || name == NULL || type_s == NULL)
+        return false;
+
+    int k;
+    for (k = 0; k < sizeof kind_names / sizeof kind_names[0]; ++k) {
+        if (strcmp(kind_s, kind_names[k]) == 0)
+            break;
+    }
+    if (k == sizeof kind_names / sizeof kind_names[0])
+        return false;
+
+    out->kind     = k;
+    out->name     = intern(name);
+    out->type     = NULL;
+    out->n_params = 0;
+    if (strcmp(type_s, "-") != 0
+            && (out->type = lookup_type_name(type_s)) == NULL)
+        return false;
+
+    char *par_name;
+    while ((par_name = strtok_r(NULL, " ", &save)) != NULL) {
+        char *par_type = strtok_r(NULL, " ", &save);
+
+        if (par_type == NULL || out->n_params >= UQ_PLUGINS_MAX_PARAMS)
+            return false;
+
+        out->par_names[out->n_params] = intern(par_name);
+        out->par_types[out->n_params] = lookup_type_name(par_type);
+        if (out->par_types[out->n_params++] == NULL)
+            return false;
+    }
+    return true;
+} /* parse_stub */
+
+/* registra como stubs los builtins de la entrada e.  Devuelve
+ * false si alguna linea es invalida (en cuyo caso no se registra
+ * ninguno) */
+static bool
+stubs_from_entry(const manifest_entry *e, int plugin_id)
+{
+    stub *stubs = calloc(e->lines_len, sizeof *stubs);
+    assert(stubs != NULL);
+
+    bool ok = true;
+    for (int i = 0; ok && i < e->lines_len; ++i) {
+        ok = parse_stub(e->lines[i], stubs + i);
+    }
+
+    for (int i = 0; ok && i < e->lines_len; ++i) {
+        const stub *s = stubs + i;
+        register_builtin_stub(s->name, s->type, s->kind,
+                plugin_id, s->n_params,
+                s->par_names, s->par_types);
+    }
+    free(stubs);
+
+    return ok;
+} /* stubs_from_entry */
+
+static bool
+load_plugin(int plugin_id, bool lazy)
+{
+    plugin *p = plugins + plugin_id;
+
+    builtins_set_loading_plugin(plugin_id, lazy);
+    p->handle = dlopen(p->path, RTLD_LAZY);
+    builtins_set_loading_plugin(-1, false);
+
+    if (p->handle == NULL) {
+        fprintf(stderr, "dlopen %s: %s\n",
+            p->path,
+            dlerror());
+        return false;
+    }
+    return true;
+} /* load_plugin */
+
+void
+plugin_cache_add(const char *path)
+{
+    struct stat st;
+
+    if (stat(path, &st) < 0) {
+        fprintf(stderr, "stat %s: %s\n",
+                path, strerror(errno));
+        return;
+    }
+
+    DYNARRAY_GROW(plugins, plugin, 1, UQ_PLUGINS_INCRMNT);
+    int     plugin_id = plugins_len++;
+    plugin *p         = plugins + plugin_id;
+
+    p->path   = intern(path);
+    p->mtime  = st.st_mtime;
+    p->size   = st.st_size;
+    p->handle = NULL;
+
+    manifest_entry *e;
+    for (e = entries; e < entries + entries_len; ++e) {
+        if (e->path == p->path)
+            break;
+    }
+
+    if (e < entries + entries_len
+            && e->mtime == p->mtime
+            && e->size  == p->size)
+    {
+        e->used = true;
+        if (e->lines_len > 0 && stubs_from_entry(e, plugin_id))
+            return; /* se cargara cuando se use */
+        if (e->lines_len > 0)
+            manifest_dirty = true;
+    } else {
+        manifest_dirty = true;
+    }
+
+    load_plugin(plugin_id, false);
+} /* plugin_cache_add */
+
+static void
+make_parent_dirs(const char *name)
+{
+    char *path = strdup(name);
+
+    for (   char *p = strchr(path + 1, '/');
+            p != NULL;
+            p = strchr(p + 1, '/'))
+    {
+        *p = '\0';
+        mkdir(path, 0777); /* errores se detectan en fopen() */
+        *p = '/';
+    }
+    free(path);
+} /* make_parent_dirs */
+
+void
+plugin_cache_close(void)
+{
+    for (int i = 0; i < entries_len; ++i) {
+        if (!entries[i].used) /* plugin desaparecido */
+            manifest_dirty = true;
+    }
+
+    if (!manifest_dirty || manifest_name == NULL)
+        return;
+
+    char tmp_name[1024];
+    snprintf(tmp_name, sizeof tmp_name,
+             "%s.%ld", manifest_name, (long) getpid());
+
+    make_parent_dirs(manifest_name);
+    FILE *f = fopen(tmp_name, "w");
+    if (f == NULL)
+        return; /* no se puede escribir la cache, seguimos sin ella */
+
+    fprintf(f, "# %s plugin manifest, generated automatically, "
+               "don't edit.\n", PROGRAM_NAME);
+
+    size_t n_builtins = get_builtins_len();
+    for (int plugin_id = 0; plugin_id < plugins_len; ++plugin_id) {
+        const plugin *p = plugins + plugin_id;
+
+        fprintf(f, "plugin %lld %lld %s\n",
+                (long long) p->mtime,
+                (long long) p->size,
+                p->path);
+
+        for (int id = 0; id < n_builtins; ++id) {
+            const builtin *b   = get_builtin_info(id);
+            const Symbol  *sym = b->sym;
+
+            if (b->plugin != plugin_id)
+                continue;
+
+            fprintf(f, "builtin %s %s %s",
+                    kind_names[b->kind],
+                    sym->name,
+                    sym->typref
+                        ? sym->typref->name
+                        : "-");
+            for (int i = 0; i < sym->argums_len; ++i) {
+                fprintf(f, " %s %s",
+                        sym->argums[i]->name,
+                        sym->argums[i]->typref->name);
+            }
+            fprintf(f, "\n");
+        }
+    }
+
+    if (fclose(f) != 0 || rename(tmp_name, manifest_name) < 0) {
+        unlink(tmp_name);
+    }
+    manifest_dirty = false;
+} /* plugin_cache_close */
+
+void
+plugin_resolve(const Symbol *sym)
+{
+    if (sym->type != BLTIN_FUNC && sym->type != BLTIN_PROC)
+        return;
+
+    const builtin *b = get_builtin_info(sym->bltin_index);
+    if (!BUILTIN_IS_STUB(b))
+        return;
+
+    int plugin_id = b->plugin;
+    assert(plugin_id >= 0 && plugin_id < plugins_len);
+
+    if (plugins[plugin_id].handle == NULL)
+        load_plugin(plugin_id, true);
+
+    if (BUILTIN_IS_STUB(get_builtin_info(sym->bltin_index))) {
+        /* el manifiesto no se corresponde con el plugin,
+         * lo borramos para que se regenere la proxima vez. */
+        if (manifest_name != NULL)
+            unlink(manifest_name);
+        execerror("builtin " GREEN "%s" ANSI_END
+                  " not provided by plugin %s",
+                  sym->name,
+                  plugins[plugin_id].path);
+    }
+} /* plugin_resolve */
@@ -0,0 +1,26 @@
+/* plugin_cache.h -- carga perezosa de plugins a traves de un
+ * manifiesto cacheado de los builtins que define cada plugin.
+ * License: BSD
+ */
+#ifndef PLUGIN_CACHE_H_3f1c2a9e_c86b_11f0_9d3e_0023ae68f329
+#define PLUGIN_CACHE_H_3f1c2a9e_c86b_11f0_9d3e_0023ae68f329
+
+#include "symbol.h"
+
+/* lee el manifiesto de plugins (si existe) */
+void plugin_cache_open(void);
+
+/* registra el plugin de nombre path.  Si el manifiesto tiene una
+ * entrada valida (mismo mtime y tama;o) para el, sus builtins se
+ * registran como stubs, sin cargar el .so.  En otro caso el plugin
+ * se carga con dlopen(3) y se anotan los builtins que registra. */
+void plugin_cache_add(const char *path);
+
+/* reescribe el manifiesto, si ha cambiado */
+void plugin_cache_close(void);
+
+/* carga el plugin que define el builtin sym, si este es aun un
+ * stub.  Lo llama el lexer cuando resuelve un nombre de builtin. */
+void plugin_resolve(const Symbol *sym);
+
+#endif /* PLUGIN_CACHE_H_3f1c2a9e_c86b_11f0_9d3e_0023ae68f329 */
@@ -0,0 +1,349 @@
+/* profile.c -- perfilado de la ejecucion de la maquina virtual
+ * (opcion -p).
+ * License: BSD
+ *
+ * Cuando se activa el perfilado, execute() delega en
+ * prof_execute(), que es una copia del bucle de la maquina
+ * virtual que ademas cuenta cuantas veces se ejecuta cada
+ * codigo de operacion y cada direccion de prog[].  Las
+ * instrucciones call y ret mantienen una pila de marcos
+ * paralela a la de la maquina, con la que se calcula el
+ * numero de instrucciones y el tiempo (de reloj) inclusivo y
+ * exclusivo de cada funcion.  El bucle normal no se modifica,
+ * de forma que sin -p no hay coste alguno. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "config.h"
+#include "colors.h"
+
+#include "cellP.h"
+#include "symbolP.h"
+#include "code.h"
+#include "dynarray.h"
+#include "lines.h"
+#include "profile.h"
+#include "ring.h"
+#include "stats.h"
+
+#ifndef   UQ_PROF_INCRMNT /* { */
+#warning  UQ_PROF_INCRMNT should be defined in config.mk
+#define   UQ_PROF_INCRMNT   (32)
+#endif /* UQ_PROF_INCRMNT    } */
+
+#ifndef   UQ_PROF_HOT_LINES /* { */
+#warning  UQ_PROF_HOT_LINES should be defined in config.mk
+#define   UQ_PROF_HOT_LINES (20)
+#endif /* UQ_PROF_HOT_LINES    } */
+
+typedef unsigned long long counter;
+
+typedef struct prof_func_s {
+    const Symbol *sym;         /* funcion/procedimiento */
+    counter       calls,       /* numero de llamadas */
+                  incl_inst,   /* instrucciones (incluidas las llamadas) */
+                  excl_inst,   /* instrucciones (solo las propias) */
+                  incl_ns,     /* tiempo de reloj (incluidas las llamadas) */
+                  excl_ns;     /* tiempo de reloj (solo el propio) */
+    int           active;      /* llamadas en curso (recursion) */
+} prof_func;
+
+typedef struct prof_line_s {
+    int           lin;         /* linea del fuente */
+    counter       count;       /* instrucciones ejecutadas en ella */
+} prof_line;
+
+typedef struct prof_frame_s {
+    int           func;        /* indice en funcs[] */
+    counter       inst0,       /* total_inst al entrar */
+                  ns0,         /* tiempo al entrar */
+                  child_inst,  /* instrucciones de las llamadas hechas */
+                  child_ns;    /* tiempo de las llamadas hechas */
+} prof_frame;
+
+int prof_enabled = 0;
+
+static counter     op_count[CELL_MAX_INSTRUCTIONS];
+static counter    *addr_count; /* contador por direccion de prog[] */
+static int        *addr_func;  /* indice + 1 en funcs[] de la funcion
+                                * que empieza en cada direccion */
+static size_t      addr_len;   /* longitud de ambas tablas */
+static Cell       *top_base,   /* codigo de nivel superior de la */
+                  *top_end;    /* ultima ejecucion */
+static counter     total_inst;
+static counter     start_ns;
+
+static prof_func  *funcs;
+static size_t      funcs_len, funcs_cap;
+
+static prof_frame *frames;
+static size_t      frames_len, frames_cap;
+
+static counter now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+} /* now_ns */
+
+void prof_init(void)
+{
+    prof_enabled = 1;
+    start_ns     = now_ns();
+    atexit(prof_report);
+} /* prof_init */
+
+static void prof_enter(const Cell *pc)
+{
+    int ix = addr_func[pc[0].param];
+
+    if (ix == 0) { /* primera llamada */
+        DYNARRAY_GROW(funcs, prof_func, 1, UQ_PROF_INCRMNT);
+        funcs[funcs_len] = (prof_func) { .sym = pc[1].sym };
+        ix = addr_func[pc[0].param] = ++funcs_len;
+    }
+    prof_func *f = funcs + ix - 1;
+    f->calls++;
+    f->active++;
+
+    DYNARRAY_GROW(frames, prof_frame, 1, UQ_PROF_INCRMNT);
+    frames[frames_len++] = (prof_frame) {
+        .func  = ix - 1,
+        .inst0 = total_inst,
+        .ns0   = now_ns(),
+    };
+} /* prof_enter */
+
+static void prof_leave(void)
+{
+    if (frames_len == 0)
+        return;
+
+    prof_frame *fr   = frames + --frames_len;
+    prof_func  *f    = funcs + fr->func;
+    counter     inst = total_inst - fr->inst0,
+                ns   = now_ns() - fr->ns0;
+
+    f->excl_inst += inst - fr->child_inst;
+    f->excl_ns   += ns   - fr->child_ns;
+
+    /* en las llamadas recursivas solo se acumula el tiempo
+     * inclusivo de la mas externa, para no contarlo varias
+     * veces. */
+    if (--f->active == 0) {
+        f->incl_inst += inst;
+        f->incl_ns   += ns;
+    }
+    if (frames_len > 0) {
+        frames[frames_len - 1].child_inst += inst;
+        frames[frames_len - 1].child_ns   += ns;
+    }
+} /* prof_leave */
+
+/* los contadores por direccion cubren el codigo generado hasta
+ * ahora, que crece con el programa (ver progmem.c) */
+static void grow_addr_tables(size_t len)
+{
+    if (len <= addr_len)
+        return;
+
+    addr_count = realloc(addr_count, len * sizeof *addr_count);
+    addr_func  = realloc(addr_func,  len * sizeof *addr_func);
+    if (!addr_count || !addr_func) {
+        fprintf(stderr, "profile: no memory\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(addr_count + addr_len, 0, (len - addr_len) * sizeof *addr_count);
+    memset(addr_func  + addr_len, 0, (len - addr_len) * sizeof *addr_func);
+    addr_len = len;
+} /* grow_addr_tables */
+
+void prof_execute(Cell *p)
+{
+    grow_addr_tables(progp - prog + 1); /* +1: el STOP final */
+
+    /* descartamos los marcos que hayan quedado de una ejecucion
+     * abortada por execerror() */
+    while (frames_len > 0)
+        funcs[frames[--frames_len].func].active--;
+
+    /* el codigo de nivel superior se reescribe en cada sentencia
+     * (y puede haberse sobreescrito con la definicion de una
+     * funcion), asi que los contadores de la ultima ejecucion
+     * se reinician. */
+    if (top_base != NULL)
+        memset(addr_count + (top_base - prog), 0,
+                (top_end - top_base) * sizeof *addr_count);
+    top_base = progbase;
+    top_end  = progp;
+
+    pc = p;
+    const instr *instruction = NULL,
+                *STOP        = instruction_table + INST_STOP;
+    do {
+        instruction = instruction_table + pc->inst;
+
+        op_count[pc->inst]++;
+        addr_count[pc - prog]++;
+        total_inst++;
+        RING_RECORD(pc, sp);
+        exec_stats.insts++;
+
+        switch (pc->inst) {
+        case INST_call:          prof_enter(pc); break;
+        case INST_leave_ret:
+        case INST_leave_ret_val: prof_leave();   break;
+        default: break;
+        }
+
+        instruction->exec(instruction);
+    } while(instruction != STOP);
+} /* prof_execute */
+
+static int by_op_count(const void *a, const void *b)
+{
+    counter ca = op_count[*(const int *)a],
+            cb = op_count[*(const int *)b];
+    return (ca < cb) - (ca > cb);
+} /* by_op_count */
+
+static int by_excl_inst(const void *a, const void *b)
+{
+    const prof_func *fa = a, *fb = b;
+    return (fa->excl_inst < fb->excl_inst)
+         - (fa->excl_inst > fb->excl_inst);
+} /* by_excl_inst */
+
+static int by_lin(const void *a, const void *b)
+{
+    const prof_line *la = a, *lb = b;
+    return (la->lin > lb->lin) - (la->lin < lb->lin);
+} /* by_lin */
+
+static int by_line_count(const void *a, const void *b)
+{
+    const prof_line *la = a, *lb = b;
+    return (la->count < lb->count) - (la->count > lb->count);
+} /* by_line_count */
+
+/* lineas del fuente mas ejecutadas, sumando los contadores de
+ * todas las direcciones generadas desde cada una */
+static void report_lines(void)
+{
+    prof_line *lines     = NULL;
+    size_t     lines_len = 0,
+               lines_cap = 0;
+    int        lin, col;
+
+    for (const Cell *ip = prog; ip < progp; ip++) {
+        if (addr_count[ip - prog] == 0
+                || !lines_lookup(ip - prog, &lin, &col))
+            continue;
+        DYNARRAY_GROW(lines, prof_line, 1, UQ_PROF_INCRMNT);
+        lines[lines_len].lin   = lin;
+        lines[lines_len].count = addr_count[ip - prog];
+        lines_len++;
+    }
+    if (lines_len == 0)
+        return;
+
+    /* agrupamos por linea */
+    qsort(lines, lines_len, sizeof lines[0], by_lin);
+    size_t n = 0;
+    for (size_t j = 1; j < lines_len; j++) {
+        if (lines[j].lin == lines[n].lin)
+            lines[n].count += lines[j].count;
+        else
+            lines[++n] = lines[j];
+    }
+    lines_len = n + 1;
+    qsort(lines, lines_len, sizeof lines[0], by_line_count);
+
+    double total = total_inst ? total_inst : 1;
+    printf("\n" BRIGHT "%-16s %14s %7s" ANSI_END "\n",
+            "LINE", "INSTR", "%");
+    for (size_t j = 0; j < lines_len && j < UQ_PROF_HOT_LINES; j++)
+        printf(GREEN "%-16d" ANSI_END " %14llu %6.2f%%\n",
+                lines[j].lin, lines[j].count,
+                100.0 * lines[j].count / total);
+    free(lines);
+} /* report_lines */
+
+void prof_report(void)
+{
+    double  secs  = (now_ns() - start_ns) / 1.0E9;
+
+    grow_addr_tables(progp - prog + 1);
+    double  total = total_inst ? total_inst : 1;
+
+    printf(BRIGHT "PROFILE" ANSI_END ": %llu instructions in %.6f s"
+            " (%.0f instr/s)\n",
+            total_inst, secs, secs > 0.0 ? total_inst / secs : 0.0);
+
+    /* instrucciones, por orden de frecuencia */
+    int ops[CELL_MAX_INSTRUCTIONS], ops_len = 0;
+    for (int op = 0; op < instruction_table_len; op++)
+        if (op_count[op])
+            ops[ops_len++] = op;
+    qsort(ops, ops_len, sizeof ops[0], by_op_count);
+
+    printf("\n" BRIGHT "%-16s %14s %7s" ANSI_END "\n",
+            "OPCODE", "COUNT", "%");
+    for (int j = 0; j < ops_len; j++)
+        printf(CYAN "%-16s" ANSI_END " %14llu %6.2f%%\n",
+                instruction_table[ops[j]].name,
+                op_count[ops[j]],
+                100.0 * op_count[ops[j]] / total);
+
+    /* funciones, por orden de instrucciones propias */
+    counter funcs_inst = 0;
+    for (size_t j = 0; j < funcs_len; j++)
+        funcs_inst += funcs[j].excl_inst;
+    qsort(funcs, funcs_len, sizeof funcs[0], by_excl_inst);
+
+    printf("\n" BRIGHT "%-16s %6s %10s %14s %14s %12s %12s" ANSI_END "\n",
+            "FUNCTION", "LINE", "CALLS", "INCL_INSTR", "EXCL_INSTR",
+            "INCL_MS", "EXCL_MS");
+    for (size_t j = 0; j < funcs_len; j++) {
+        prof_func *f = funcs + j;
+        int        lin, col;
+        if (!lines_lookup(f->sym->defn - prog, &lin, &col))
+            lin = 0;
+        printf(GREEN "%-16s" ANSI_END " %6d %10llu %14llu %14llu"
+                " %12.3f %12.3f\n",
+                f->sym->name, lin, f->calls,
+                f->incl_inst, f->excl_inst,
+                f->incl_ns / 1.0E6, f->excl_ns / 1.0E6);
+    }
+    printf(GREEN "%-16s" ANSI_END " %6s %10s %14llu %14llu\n",
+            "<toplevel>", "-", "-", total_inst, total_inst - funcs_inst);
+
+    report_lines();
+
+    /* listado anotado, como el de la sentencia list */
+    printf("\n" BRIGHT "ANNOTATED LISTING" ANSI_END "\n");
+    const Cell *ip = prog;
+    int         last_lin = 0;
+    while (ip->inst != INST_STOP) {
+        const instr *i = instruction_table + ip->inst;
+        int          lin, col;
+        if (ip == progbase)
+            printf("START:\n");
+        if (lines_lookup(ip - prog, &lin, &col) && lin != last_lin) {
+            printf("%12s ; linea %d\n", "", lin);
+            last_lin = lin;
+        }
+        if (addr_count[ip - prog])
+            printf("%12llu ", addr_count[ip - prog]);
+        else
+            printf("%12s ", ".");
+        i->print(i, ip);
+        ip += i->n_cells;
+    }
+    const instr *stop = instruction_table + INST_STOP;
+    printf("%12llu ", addr_count[ip - prog]);
+    stop->print(stop, ip);
+} /* prof_report */
@@ -0,0 +1,25 @@
+/* profile.h -- perfilado de la ejecucion de la maquina virtual
+ * (opcion -p).
+ * License: BSD
+ */
+#ifndef PROFILE_H_6a0e2b14_ca0f_11f0_8d21_0023ae68f329
+#define PROFILE_H_6a0e2b14_ca0f_11f0_8d21_0023ae68f329
+
+#include "cell.h"
+
+/* distinto de cero si se ha activado el perfilado */
+extern int prof_enabled;
+
+/* activa el perfilado y programa la impresion del informe
+ * a la salida del programa (con atexit(3)) */
+void prof_init(void);
+
+/* version de execute() que cuenta las instrucciones ejecutadas
+ * (por codigo de operacion y por direccion) y el numero de
+ * instrucciones y el tiempo gastado en cada funcion. */
+void prof_execute(Cell *p);
+
+/* imprime el informe y el listado anotado del programa */
+void prof_report(void);
+
+#endif /* PROFILE_H_6a0e2b14_ca0f_11f0_8d21_0023ae68f329 */
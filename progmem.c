@@ -0,0 +1,147 @@
+/* progmem.c -- memoria de programa (prog[]): reserva de un
+ * rango grande de direcciones que se compromete a demanda.
+ * License: BSD
+ *
+ * prog[] era un array estatico de UQ_NPROG celdas.  Ahora se
+ * reservan UQ_NPROG celdas de espacio de direcciones sin acceso
+ * (PROT_NONE), y se van haciendo accesibles, de UQ_PROG_COMMIT
+ * en UQ_PROG_COMMIT celdas, a medida que crecen el codigo
+ * (hacia arriba, desde prog) y las variables globales (hacia
+ * abajo, desde el final):
+ *
+ *   [ codigo | ... reservado ... | globales ]
+ *   ^        ^                   ^          ^
+ *   prog     progmem_code_end    |          prog + UQ_NPROG
+ *                                progmem_vars_start
+ *
+ * Si el sistema no permite reservar UQ_NPROG celdas (p.ej. por
+ * ulimit -v), se prueba con la mitad, y asi sucesivamente.
+ * Con UQ_PROG_HUGEPAGE_MIN distinto de cero, cuando el codigo
+ * llega a ese numero de celdas se pide al nucleo que use
+ * paginas enormes (transparent huge pages) para prog[]. */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "config.h"
+
+#include "cellP.h"
+#include "code.h"
+#include "error.h"
+#include "progmem.h"
+
+#ifndef  UQ_NPROG
+#warning UQ_NPROG debe definirse en config.mk
+#define  UQ_NPROG 10000
+#endif
+
+#ifndef   UQ_PROG_COMMIT /* { */
+#warning  UQ_PROG_COMMIT should be defined in config.mk
+#define   UQ_PROG_COMMIT        (65536)
+#endif /* UQ_PROG_COMMIT    } */
+
+#ifndef   UQ_PROG_HUGEPAGE_MIN /* { */
+#warning  UQ_PROG_HUGEPAGE_MIN should be defined in config.mk
+#define   UQ_PROG_HUGEPAGE_MIN  (0)
+#endif /* UQ_PROG_HUGEPAGE_MIN    } */
+
+Cell *prog;   /* the machine memory */
+
+Cell *progmem_code_end,
+     *progmem_vars_start;
+
+static size_t prog_size;       /* celdas reservadas */
+static size_t commit_cells;    /* UQ_PROG_COMMIT, en paginas enteras */
+static int    huge_done;
+
+static void commit(Cell *lo, Cell *hi)
+{
+    if (mprotect(lo, (hi - lo) * sizeof(Cell),
+                PROT_READ | PROT_WRITE) < 0)
+    {
+        execerror("prog[]: cannot commit %ld cells: %s",
+                (long)(hi - lo), strerror(errno));
+    }
+} /* commit */
+
+void progmem_init(void)
+{
+    size_t page = sysconf(_SC_PAGESIZE);
+
+    commit_cells = (UQ_PROG_COMMIT * sizeof(Cell) + page - 1)
+                 / page * page / sizeof(Cell);
+
+    for (prog_size = UQ_NPROG;; prog_size /= 2) {
+        prog_size = prog_size / commit_cells * commit_cells;
+        if (prog_size < 2 * commit_cells) {
+            fprintf(stderr, "prog[]: cannot reserve memory: %s\n",
+                    strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+        prog = mmap(NULL, prog_size * sizeof(Cell),
+                PROT_NONE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                -1, 0);
+        if (prog != MAP_FAILED)
+            break;
+    }
+
+    progmem_code_end   = prog;
+    progmem_vars_start = prog + prog_size;
+
+    progp    =
+    progbase =
+    pc       = prog;
+    varbase  = prog + prog_size;
+} /* progmem_init */
+
+void progmem_grow_code(const Cell *end)
+{
+    if (end > varbase)
+        execerror("program too big (max=%zu)", prog_size);
+
+    Cell *hi = prog + (end - prog + commit_cells - 1)
+                      / commit_cells * commit_cells;
+    if (hi > progmem_vars_start)
+        hi = progmem_vars_start;
+
+    commit(progmem_code_end, hi);
+    progmem_code_end = hi;
+
+#ifdef MADV_HUGEPAGE
+    if (UQ_PROG_HUGEPAGE_MIN > 0 && !huge_done
+            && progmem_code_end - prog >= UQ_PROG_HUGEPAGE_MIN)
+    {
+        madvise(prog, prog_size * sizeof(Cell), MADV_HUGEPAGE);
+        huge_done = 1;
+    }
+#endif
+} /* progmem_grow_code */
+
+void progmem_grow_vars(const Cell *start)
+{
+    if (start < progp)
+        execerror("variables zone exhausted (progp >= varbase)");
+
+    Cell *lo = prog + (start - prog) / commit_cells * commit_cells;
+    if (lo < progmem_code_end)
+        lo = progmem_code_end;
+
+    commit(lo, progmem_vars_start);
+    progmem_vars_start = lo;
+} /* progmem_grow_vars */
+
+size_t progmem_size(void)
+{
+    return prog_size;
+} /* progmem_size */
+
+size_t progmem_committed(void)
+{
+    return (progmem_code_end - prog)
+         + (prog + prog_size - progmem_vars_start);
+} /* progmem_committed */
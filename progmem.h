@@ -0,0 +1,34 @@
+/* progmem.h -- memoria de programa (prog[]): reserva de un
+ * rango grande de direcciones que se compromete a demanda.
+ * License: BSD
+ */
+#ifndef PROGMEM_H_9e41c3a6_cec1_11f0_84f2_0023ae68f329
+#define PROGMEM_H_9e41c3a6_cec1_11f0_84f2_0023ae68f329
+
+#include <stddef.h>
+
+#include "cell.h"
+
+/* limites de las zonas ya comprometidas: el codigo ocupa
+ * [prog, progmem_code_end) y las variables globales
+ * [progmem_vars_start, prog + progmem_size()). */
+extern Cell *progmem_code_end,
+            *progmem_vars_start;
+
+/* reserva prog[] e inicializa progp, progbase, pc y varbase.
+ * Debe llamarse antes de generar codigo o instalar variables
+ * (lo hace init()). */
+void progmem_init(void);
+
+/* comprometen la memoria hasta end (para codigo) o desde
+ * start (para variables globales).  Si no cabe, execerror().
+ * Solo hay que llamarlas cuando end > progmem_code_end o
+ * start < progmem_vars_start. */
+void progmem_grow_code(const Cell *end);
+void progmem_grow_vars(const Cell *start);
+
+/* celdas reservadas y comprometidas */
+size_t progmem_size(void);
+size_t progmem_committed(void);
+
+#endif /* PROGMEM_H_9e41c3a6_cec1_11f0_84f2_0023ae68f329 */
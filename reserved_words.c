@@ -25,14 +25,19 @@ static const reserved_word reserved_words[] = {
     RW(brkpt,      BRKPT),
     RW(const,      CONST),
     RW(else,       ELSE),
+    RW(for,        FOR),
     RW(func,       FUNC),
     RW(if,         IF),
+    RW(inline,     INLINE),
     RW(list,       LIST),
     RW(print,      PRINT),
     RW(proc,       PROC),
     RW(return,     RETURN),
+    RW(stats,      STATS),
+    RW(step,       STEP),
     RW(symbs_all,  SYMBS_ALL),
     RW(symbs,      SYMBS),
+    RW(to,         TO),
     RW(while,      WHILE),
 
     { .name = NULL }
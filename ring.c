@@ -0,0 +1,43 @@
+/* ring.c -- registro circular de las ultimas instrucciones
+ * ejecutadas, para diagnosticar los errores de ejecucion.
+ * License: BSD
+ *
+ * El registro esta siempre activo.  execute() y prof_execute()
+ * anotan en el, antes de ejecutarla, cada instruccion (su
+ * direccion, su codigo y el sp), y execerror() lo vuelca cuando
+ * el error se produce durante la ejecucion.  La ultima
+ * instruccion del volcado es la que ha fallado. */
+
+#include <stdio.h>
+
+#include "config.h"
+#include "colors.h"
+
+#include "cellP.h"
+#include "code.h"
+#include "stack.h"
+#include "ring.h"
+
+ring_rec      ring_buf[UQ_RING_SIZE];
+unsigned long ring_start;
+
+void ring_dump(void)
+{
+    /* exec_stats.insts ya cuenta la instruccion que ha fallado */
+    unsigned long end = exec_stats.insts,
+                  n   = end - ring_start;
+
+    if (n > UQ_RING_SIZE)
+        n = UQ_RING_SIZE;
+    if (n == 0)
+        return;
+
+    printf(BRIGHT "last %lu instructions executed:" ANSI_END "\n", n);
+    for (unsigned long k = end - n; k < end; k++) {
+        const ring_rec *r = ring_buf + (k & (UQ_RING_SIZE - 1));
+        const instr    *i = instruction_table + r->op;
+
+        printf("  sp=%-6ld ", (long)(stack_top - r->sp));
+        i->print(i, r->pc);
+    }
+} /* ring_dump */
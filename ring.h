@@ -0,0 +1,52 @@
+/* ring.h -- registro circular de las ultimas instrucciones
+ * ejecutadas, para diagnosticar los errores de ejecucion.
+ * License: BSD
+ */
+#ifndef RING_H_3f6d1b28_ceff_11f0_a7e3_0023ae68f329
+#define RING_H_3f6d1b28_ceff_11f0_a7e3_0023ae68f329
+
+#include "config.h"
+
+#include "cellP.h"
+#include "stats.h"
+
+#ifndef   UQ_RING_SIZE /* { */
+#warning  UQ_RING_SIZE should be defined in config.mk
+#define   UQ_RING_SIZE          (16)
+#endif /* UQ_RING_SIZE    } */
+
+#if UQ_RING_SIZE & (UQ_RING_SIZE - 1)
+#error UQ_RING_SIZE must be a power of two
+#endif
+
+typedef struct ring_rec_s {
+    const Cell *pc;
+    const Cell *sp;
+    instr_code  op;
+} ring_rec;
+
+extern ring_rec      ring_buf[UQ_RING_SIZE];
+extern unsigned long ring_start; /* exec_stats.insts al empezar */
+
+/* anota la instruccion en pc antes de ejecutarla.  Usa como
+ * indice el contador de instrucciones de exec_stats, que los
+ * bucles de la maquina incrementan de todas formas, asi que
+ * solo cuesta tres almacenamientos por instruccion. */
+#define RING_RECORD(_pc, _sp) do {                            \
+        ring_rec *_r = ring_buf                               \
+                     + (exec_stats.insts & (UQ_RING_SIZE - 1)); \
+        _r->pc = (_pc);                                       \
+        _r->sp = (_sp);                                       \
+        _r->op = (_pc)->inst;                                 \
+    } while (0) /* RING_RECORD */
+
+/* marca el comienzo de una ejecucion: solo se vuelcan las
+ * instrucciones de la ejecucion en curso, pues el codigo de
+ * las anteriores puede haberse reescrito. */
+#define RING_BEGIN() (ring_start = exec_stats.insts)
+
+/* imprime las ultimas instrucciones ejecutadas, la mas antigua
+ * primero, con las rutinas _prt de cada instruccion. */
+void ring_dump(void);
+
+#endif /* RING_H_3f6d1b28_ceff_11f0_a7e3_0023ae68f329 */
@@ -0,0 +1,271 @@
+/* sample.c -- perfilado por muestreo (opcion -P), con salida
+ * en formato "folded stacks" para generar flame graphs.
+ * License: BSD
+ *
+ * Un temporizador ITIMER_PROF envia SIGPROF a intervalos
+ * regulares de tiempo de CPU.  El manejador toma el pc actual y
+ * recorre la cadena de frame pointers de la maquina virtual
+ * (fp[0] es el fp del llamante, guardado por enter, y fp[1]
+ * la direccion de retorno, guardada por call), traduciendo cada
+ * direccion a la funcion que la contiene con los rangos
+ * [defn, defn_end) de los simbolos.  Las pilas resultantes se
+ * acumulan en una tabla hash preasignada (en el manejador no
+ * se puede llamar a malloc(3)), y se escriben al terminar el
+ * programa, una por linea, en el formato
+ *
+ *   <toplevel>;f;g 123
+ *
+ * que entienden flamegraph.pl y herramientas similares. */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "config.h"
+
+#include "cellP.h"
+#include "symbolP.h"
+#include "code.h"
+#include "hoc.h"
+#include "scope.h"
+#include "dynarray.h"
+#include "sample.h"
+#include "stack.h"
+
+#ifndef   UQ_SAMPLE_HZ /* { */
+#warning  UQ_SAMPLE_HZ should be defined in config.mk
+#define   UQ_SAMPLE_HZ          (997)
+#endif /* UQ_SAMPLE_HZ    } */
+
+#ifndef   UQ_SAMPLE_MAX_DEPTH /* { */
+#warning  UQ_SAMPLE_MAX_DEPTH should be defined in config.mk
+#define   UQ_SAMPLE_MAX_DEPTH   (128)
+#endif /* UQ_SAMPLE_MAX_DEPTH    } */
+
+#ifndef   UQ_SAMPLE_SLOTS /* { */
+#warning  UQ_SAMPLE_SLOTS should be defined in config.mk
+#define   UQ_SAMPLE_SLOTS       (8192)
+#endif /* UQ_SAMPLE_SLOTS    } */
+
+#ifndef   UQ_SAMPLE_STORE /* { */
+#warning  UQ_SAMPLE_STORE should be defined in config.mk
+#define   UQ_SAMPLE_STORE       (262144)
+#endif /* UQ_SAMPLE_STORE    } */
+
+#ifndef   UQ_SAMPLE_INCRMNT /* { */
+#warning  UQ_SAMPLE_INCRMNT should be defined in config.mk
+#define   UQ_SAMPLE_INCRMNT     (32)
+#endif /* UQ_SAMPLE_INCRMNT    } */
+
+/* identificadores de los marcos de pila que no son funciones */
+enum {
+    SAMPLE_TOPLEVEL,  /* codigo de nivel superior */
+    SAMPLE_COMPILE,   /* fuera de execute() */
+    SAMPLE_UNKNOWN,   /* direccion fuera de toda funcion */
+    SAMPLE_FIRST_FUNC,
+};
+
+static const char *const pseudo_names[] = {
+    [SAMPLE_TOPLEVEL] = "<toplevel>",
+    [SAMPLE_COMPILE]  = "<compile>",
+    [SAMPLE_UNKNOWN]  = "<unknown>",
+};
+
+typedef struct sample_slot_s {
+    unsigned      hash;
+    int           off,    /* posicion de la pila en store[] */
+                  len;    /* numero de marcos (0 si el slot esta libre) */
+    unsigned long count;  /* numero de muestras */
+} sample_slot;
+
+int sample_enabled = 0;
+
+static const char           *out_name;
+
+static volatile sig_atomic_t in_exec;
+static sample_slot           slots[UQ_SAMPLE_SLOTS];
+static int                   store[UQ_SAMPLE_STORE];
+static int                   store_len;
+static unsigned long         dropped;
+
+/* funciones, ordenadas por direccion (se definen una detras de
+ * otra, y nunca se reescriben) */
+static const Symbol        **funcs;
+static size_t                funcs_len, funcs_cap;
+static Cell                 *funcs_synced; /* progbase al sincronizar */
+
+/* busca la funcion que contiene la direccion addr */
+static int func_of(const Cell *addr)
+{
+    if (addr >= progbase)
+        return SAMPLE_TOPLEVEL;
+
+    size_t lo = 0, hi = funcs_len;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (addr < funcs[mid]->defn)
+            hi = mid;
+        else if (addr >= funcs[mid]->defn_end)
+            lo = mid + 1;
+        else
+            return SAMPLE_FIRST_FUNC + mid;
+    }
+    return SAMPLE_UNKNOWN;
+} /* func_of */
+
+static void add_stack(const int *stk, int len)
+{
+    unsigned h = 2166136261u; /* FNV-1a */
+    for (int j = 0; j < len; j++)
+        h = (h ^ stk[j]) * 16777619u;
+
+    for (unsigned n = 0; n < UQ_SAMPLE_SLOTS; n++) {
+        sample_slot *s = slots + (h + n) % UQ_SAMPLE_SLOTS;
+        if (s->len == 0) { /* slot libre, se crea la entrada */
+            if (store_len + len > UQ_SAMPLE_STORE)
+                break;
+            memcpy(store + store_len, stk, len * sizeof *stk);
+            s->hash  = h;
+            s->off   = store_len;
+            s->count = 1;
+            store_len += len;
+            s->len   = len;
+            return;
+        }
+        if (s->hash == h && s->len == len
+                && memcmp(store + s->off, stk, len * sizeof *stk) == 0) {
+            s->count++;
+            return;
+        }
+    }
+    dropped++;
+} /* add_stack */
+
+static void sample_handler(int sig)
+{
+    int saved_errno = errno;
+    int stk[UQ_SAMPLE_MAX_DEPTH], n = UQ_SAMPLE_MAX_DEPTH;
+
+    /* la pila se construye desde el final del array, de forma
+     * que la raiz queda la primera */
+    if (!in_exec) {
+        stk[--n] = SAMPLE_COMPILE;
+    } else {
+        const Cell *ip = pc, *f = fp, *s = sp;
+
+        /* enter y leave_ret* cambian sp y fp por pasos (la senal
+         * puede llegar, p.ej., entre el push(fp) y el fp = sp), y
+         * no se sabe si la direccion de retorno esta en s[0] o en
+         * f[1]: la muestra se descarta antes que atribuirla a otra
+         * funcion. */
+        if (ip->inst == INST_enter
+                || ip->inst == INST_leave_ret
+                || ip->inst == INST_leave_ret_val) {
+            errno = saved_errno;
+            return;
+        }
+
+        stk[--n] = func_of(ip);
+
+        while (f >= s && f < stack_top && n > 0) {
+            stk[--n] = func_of(f[1].cel);
+            f = f[0].cel;
+        }
+    }
+    add_stack(stk + n, UQ_SAMPLE_MAX_DEPTH - n);
+    errno = saved_errno;
+} /* sample_handler */
+
+void sample_init(const char *name)
+{
+    out_name = name;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sa_handler = sample_handler;
+    sa.sa_flags   = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGPROF, &sa, NULL) < 0) {
+        perror("sigaction(SIGPROF)");
+        exit(EXIT_FAILURE);
+    }
+
+    struct itimerval it = {
+        .it_interval = { .tv_usec = 1000000 / UQ_SAMPLE_HZ },
+        .it_value    = { .tv_usec = 1000000 / UQ_SAMPLE_HZ },
+    };
+    if (setitimer(ITIMER_PROF, &it, NULL) < 0) {
+        perror("setitimer(ITIMER_PROF)");
+        exit(EXIT_FAILURE);
+    }
+    sample_enabled = 1;
+    atexit(sample_report);
+} /* sample_init */
+
+void sample_begin(void)
+{
+    /* las funciones nuevas se a;aden a la tabla antes de
+     * permitir que el manejador la consulte */
+    if (funcs_synced != progbase) {
+        funcs_len = 0;
+        for (Symbol *sym = get_current_symbol(); sym; sym = sym->next) {
+            if ((sym->type == FUNCTION || sym->type == PROCEDURE)
+                    && sym->defn_end != NULL) {
+                DYNARRAY_GROW(funcs, const Symbol *, 1, UQ_SAMPLE_INCRMNT);
+                funcs[funcs_len++] = sym;
+            }
+        }
+        /* la tabla de simbolos tiene los mas recientes primero */
+        for (size_t j = 0; j < funcs_len / 2; j++) {
+            const Symbol *tmp = funcs[j];
+            funcs[j] = funcs[funcs_len - 1 - j];
+            funcs[funcs_len - 1 - j] = tmp;
+        }
+        funcs_synced = progbase;
+    }
+    atomic_signal_fence(memory_order_seq_cst);
+    in_exec = 1;
+} /* sample_begin */
+
+void sample_end(void)
+{
+    in_exec = 0;
+} /* sample_end */
+
+void sample_report(void)
+{
+    /* paramos el temporizador antes de recorrer la tabla */
+    struct itimerval it = { 0 };
+    setitimer(ITIMER_PROF, &it, NULL);
+
+    FILE *out = strcmp(out_name, "-") == 0
+              ? stdout
+              : fopen(out_name, "w");
+    if (out == NULL) {
+        fprintf(stderr, "%s: %s\n", out_name, strerror(errno));
+        return;
+    }
+    for (size_t j = 0; j < UQ_SAMPLE_SLOTS; j++) {
+        const sample_slot *s = slots + j;
+        if (s->len == 0)
+            continue;
+        for (int k = 0; k < s->len; k++) {
+            int id = store[s->off + k];
+            fprintf(out, "%s%s",
+                    k ? ";" : "",
+                    id < SAMPLE_FIRST_FUNC
+                        ? pseudo_names[id]
+                        : funcs[id - SAMPLE_FIRST_FUNC]->name);
+        }
+        fprintf(out, " %lu\n", s->count);
+    }
+    if (dropped)
+        fprintf(stderr, "sample: %lu samples dropped (table full)\n",
+                dropped);
+    if (out != stdout)
+        fclose(out);
+} /* sample_report */
@@ -0,0 +1,26 @@
+/* sample.h -- perfilado por muestreo (opcion -P), con salida
+ * en formato "folded stacks" para generar flame graphs.
+ * License: BSD
+ */
+#ifndef SAMPLE_H_0c5d7e2a_ca4a_11f0_a1b3_0023ae68f329
+#define SAMPLE_H_0c5d7e2a_ca4a_11f0_a1b3_0023ae68f329
+
+/* distinto de cero si se ha activado el muestreo */
+extern int sample_enabled;
+
+/* activa el muestreo (con un temporizador ITIMER_PROF) y
+ * programa la escritura de las muestras en el fichero
+ * out_name ("-" es la salida estandar) a la salida del
+ * programa. */
+void sample_init(const char *out_name);
+
+/* marcan el comienzo y el final de una ejecucion de la
+ * maquina virtual.  Fuera de ellas, las muestras se cuentan
+ * como tiempo de compilacion. */
+void sample_begin(void);
+void sample_end(void);
+
+/* escribe las muestras en formato folded stacks */
+void sample_report(void);
+
+#endif /* SAMPLE_H_0c5d7e2a_ca4a_11f0_a1b3_0023ae68f329 */
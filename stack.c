@@ -0,0 +1,108 @@
+/* stack.c -- pila de evaluacion y de llamadas de la maquina
+ * virtual, en su propia zona de memoria con paginas de guarda.
+ * License: BSD
+ *
+ * Antes la pila crecia desde varbase hacia progp, dentro de
+ * prog[], y push() comprobaba en cada llamada que no chocaba
+ * con el codigo.  Ahora tiene su propia zona, obtenida con
+ * mmap(2), y rodeada de dos paginas sin acceso:
+ *
+ *   [ guarda ][ ..... pila ..... ][ guarda ]
+ *             ^                   ^
+ *             stack_base          stack_top
+ *
+ * Un push() de mas escribe en la guarda inferior, y un pop()
+ * de mas lee de la superior.  Ambos provocan un SIGSEGV que
+ * el manejador convierte en un execerror() normal, de forma
+ * que push() y pop() ya no comprueban nada.  Las paginas de
+ * la pila que no se usan no llegan a ocupar memoria. */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "config.h"
+
+#include "cellP.h"
+#include "error.h"
+#include "stack.h"
+
+#ifndef   UQ_STACK_SIZE /* { */
+#warning  UQ_STACK_SIZE should be defined in config.mk
+#define   UQ_STACK_SIZE         (1048576)
+#endif /* UQ_STACK_SIZE    } */
+
+Cell *stack_base,
+     *stack_top;
+
+static char  *low_guard,    /* pagina bajo stack_base */
+             *high_guard;   /* pagina en stack_top */
+static size_t page_size;
+
+static void segv_handler(int sig, siginfo_t *info, void *ctx)
+{
+    char *addr = info->si_addr;
+
+    if (addr >= low_guard && addr < low_guard + page_size)
+        execerror("stack overflow (%zu cells)", stack_cells());
+    if (addr >= high_guard && addr < high_guard + page_size)
+        execerror("stack underflow");
+
+    /* no es de la pila: dejamos que el fallo se repita con la
+     * accion por defecto */
+    signal(SIGSEGV, SIG_DFL);
+} /* segv_handler */
+
+void stack_init(size_t cells)
+{
+    if (stack_top != NULL)
+        return;
+
+    if (cells == 0)
+        cells = UQ_STACK_SIZE;
+
+    page_size   = sysconf(_SC_PAGESIZE);
+    size_t size = (cells * sizeof(Cell) + page_size - 1)
+                & ~(page_size - 1);
+
+    char *mem = mmap(NULL, size + 2 * page_size,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+            -1, 0);
+    if (mem == MAP_FAILED) {
+        fprintf(stderr, "stack: mmap(%zu bytes): %s\n",
+                size + 2 * page_size, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    low_guard  = mem;
+    high_guard = mem + page_size + size;
+    if (mprotect(low_guard,  page_size, PROT_NONE) < 0
+     || mprotect(high_guard, page_size, PROT_NONE) < 0)
+    {
+        fprintf(stderr, "stack: mprotect: %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    stack_base = (Cell *)(low_guard + page_size);
+    stack_top  = (Cell *)high_guard;
+
+    /* SA_NODEFER: execerror() sale del manejador con longjmp(),
+     * y SIGSEGV no debe quedar bloqueada para el siguiente */
+    struct sigaction sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sa_sigaction = segv_handler;
+    sa.sa_flags     = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGSEGV, &sa, NULL) < 0) {
+        perror("sigaction(SIGSEGV)");
+        exit(EXIT_FAILURE);
+    }
+} /* stack_init */
+
+size_t stack_cells(void)
+{
+    return stack_top - stack_base;
+} /* stack_cells */
@@ -0,0 +1,26 @@
+/* stack.h -- pila de evaluacion y de llamadas de la maquina
+ * virtual, en su propia zona de memoria con paginas de guarda.
+ * License: BSD
+ */
+#ifndef STACK_H_5b7e0c94_ce3f_11f0_b2d8_0023ae68f329
+#define STACK_H_5b7e0c94_ce3f_11f0_b2d8_0023ae68f329
+
+#include <stddef.h>
+
+#include "cell.h"
+
+/* limites de la pila: sp crece hacia abajo desde stack_top
+ * (pila vacia) hasta stack_base (pila llena). */
+extern Cell *stack_base,
+            *stack_top;
+
+/* reserva una pila de cells celdas (redondeadas a paginas),
+ * con una pagina de guarda a cada lado, e instala el manejador
+ * de SIGSEGV que convierte el acceso a ellas en un execerror().
+ * Solo tiene efecto la primera vez que se llama. */
+void stack_init(size_t cells);
+
+/* tama;o de la pila, en celdas */
+size_t stack_cells(void);
+
+#endif /* STACK_H_5b7e0c94_ce3f_11f0_b2d8_0023ae68f329 */
@@ -0,0 +1,79 @@
+/* stats.c -- estadisticas de ejecucion (sentencia stats y
+ * opcion -s).
+ * License: BSD
+ *
+ * Los contadores los mantiene la propia maquina: execute()
+ * cuenta las instrucciones, call/leave_ret/bltin* las llamadas,
+ * y enter/spadd la profundidad maxima de la pila, de forma que
+ * estan siempre disponibles sin apenas coste.  Las
+ * instrucciones de plugins (ver register_instruction()) se
+ * cuentan como instrucciones, no como llamadas a builtins. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#include "config.h"
+#include "colors.h"
+
+#include "cellP.h"
+#include "symbolP.h"
+#include "code.h"
+#include "intern.h"
+#include "lines.h"
+#include "progmem.h"
+#include "scope.h"
+#include "stack.h"
+#include "stats.h"
+
+struct exec_stats_s exec_stats;
+
+#define S(_name, _fmt, ...) \
+    printf(BRIGHT "%-18s" ANSI_END " " _fmt "\n", _name, ##__VA_ARGS__)
+
+void stats_print(void)
+{
+    long code  = progp - prog,
+         vars  = prog + progmem_size() - varbase,
+         avail = varbase - progp;
+
+    size_t strs, strs_bytes;
+    intern_stats(&strs, &strs_bytes);
+
+    size_t syms = 0;
+    for (Symbol *sym = get_current_symbol(); sym; sym = sym->next)
+        syms++;
+
+    S("instructions",    "%lu", exec_stats.insts);
+    S("calls/returns",   "%lu/%lu", exec_stats.calls, exec_stats.rets);
+    S("builtin calls",   "%lu", exec_stats.bltins);
+    S("max stack depth", "%ld of %zu cells (at function entry)",
+                         exec_stats.max_depth, stack_cells());
+    S("prog[]",          "%ld cells code, %ld cells variables, "
+                         "%ld of %zu cells free (%.1f%%), "
+                         "%zu cells committed",
+                         code, vars, avail, progmem_size(),
+                         100.0 * avail / progmem_size(),
+                         progmem_committed());
+    S("interned strings", "%zu (%zu bytes)", strs, strs_bytes);
+    S("line table",      "%zu bytes", lines_size());
+    S("symbols",         "%zu", syms);
+} /* stats_print */
+
+static void stats_at_exit(void)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+
+    double cpu = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1.0E6
+               + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1.0E6;
+
+    stats_print();
+    S("cpu time",        "%.6f s", cpu);
+    S("instr/s",         "%.0f", cpu > 0.0 ? exec_stats.insts / cpu : 0.0);
+} /* stats_at_exit */
+
+void stats_init(void)
+{
+    atexit(stats_at_exit);
+} /* stats_init */
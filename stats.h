@@ -0,0 +1,27 @@
+/* stats.h -- estadisticas de ejecucion (sentencia stats y
+ * opcion -s).
+ * License: BSD
+ */
+#ifndef STATS_H_e3c41f52_cc5c_11f0_8a0d_0023ae68f329
+#define STATS_H_e3c41f52_cc5c_11f0_8a0d_0023ae68f329
+
+/* contadores que actualiza la maquina virtual (code.c) */
+struct exec_stats_s {
+    unsigned long insts,     /* instrucciones ejecutadas */
+                  calls,     /* llamadas a funciones/procedimientos */
+                  rets,      /* retornos */
+                  bltins;    /* llamadas a builtins (bltin, bltin_dd y
+                              * bltin_ddd) */
+    long          max_depth; /* maxima profundidad de la pila (celdas) */
+};
+
+extern struct exec_stats_s exec_stats;
+
+/* imprime las estadisticas (sentencia stats) */
+void stats_print(void);
+
+/* opcion -s: imprime las estadisticas, el tiempo de CPU y las
+ * instrucciones por segundo al terminar el programa */
+void stats_init(void);
+
+#endif /* STATS_H_e3c41f52_cc5c_11f0_8a0d_0023ae68f329 */
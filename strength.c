@@ -0,0 +1,216 @@
+/* strength.c -- pasada de la IR que sustituye las potencias de
+ * exponente constante y las divisiones enteras por una constante
+ * por operaciones mas baratas.
+ * License: BSD
+ *
+ * Se buscan un constpush seguido del operador, ya que la
+ * constante es el segundo operando:
+ *
+ *   x  constpush e  pwr    ->  x  dupl mul ...   (x^e)
+ *   x  constpush k  divi   ->  x  divk k  o  divp2 n
+ *   x  constpush k  mod    ->  x  modk k  o  modp2 k - 1
+ *
+ * o, en las asignaciones compuestas (x ^^= e, x /= k, ...),
+ * "constpush e; eval x; swap; pwr", que queda como "eval x" y lo
+ * mismo que antes.
+ *
+ * La potencia pasa a ser una cadena de multiplicaciones por
+ * cuadrados sucesivos: cada bit a uno del exponente deja una
+ * copia del cuadrado que le toca en la pila (dupl) y al final se
+ * multiplican todas.  Se hace con los exponentes enteros de 1 a
+ * UQ_STRENGTH_MAX_EXP de char, int y long (0 sigue siendo pwr,
+ * que da error con 0^0); si el resultado no cabe, la cadena da
+ * lo mismo que los demas operadores enteros en lugar de lo que
+ * sale de pasar por double en fast_pwr_l().  Con double y float
+ * solo con 0, 1 y 2, cuyo resultado es exacto, igual que el de
+ * pow(); con mas multiplicaciones el redondeo puede ser
+ * distinto.  Short se queda fuera porque su mul opera sobre
+ * .chr.
+ *
+ * Las divisiones y modulos de int y long por una constante
+ * distinta de cero no necesitan comprobar el divisor (divk,
+ * modk), y si es una potencia de dos se hacen con
+ * desplazamientos y mascaras (divp2, modp2, ver code.c). */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+
+#include "cellP.h"
+#include "instr.h"
+#include "ir.h"
+#include "types.h"
+
+#ifndef   UQ_STRENGTH_MAX_EXP /* { */
+#warning  UQ_STRENGTH_MAX_EXP should be defined in config.mk
+#define   UQ_STRENGTH_MAX_EXP   (8)
+#endif /* UQ_STRENGTH_MAX_EXP    } */
+
+/* nodos que como mucho ocupa la cadena de multiplicaciones: dos
+ * por cuadrado y dos por bit a uno */
+#define MAX_CHAIN   (4 * 8 * sizeof(long))
+
+static bool is_op(const instr *i, instr_code op)
+{
+    return i != NULL && i->code_id == op;
+} /* is_op */
+
+/* valor entero de la constante de un constpush de typ, o false
+ * si no lo es */
+static bool int_value(const type2inst *typ, const ir_node *n, long *out)
+{
+    double d;
+
+    if      (typ == &t2i_c) { *out = n->cel[1].chr; return true; }
+    else if (typ == &t2i_i) { *out = n->cel[1].itg; return true; }
+    else if (typ == &t2i_l) { *out = n->cel[1].lng; return true; }
+    else if (typ == &t2i_d) d = n->cel[1].dbl;
+    else if (typ == &t2i_f) d = n->cel[1].flt;
+    else return false;
+
+    if (!(d >= 0.0 && d <= UQ_STRENGTH_MAX_EXP) || d != (long) d)
+        return false;
+    *out = (long) d;
+    return true;
+} /* int_value */
+
+/* sustitucion de "constpush e; pwr" por la cadena de x^e.
+ * Devuelve su longitud, o -1 si no se hace. */
+static int pwr_chain(
+        const type2inst *typ,
+        long             e,
+        const ir_node   *at,
+        ir_node         *seq)
+{
+    int  lin = at->lin,
+         col = at->col,
+         k   = 0,
+         top = 0;
+
+    if (typ == &t2i_s || e < 0 || e > UQ_STRENGTH_MAX_EXP)
+        return -1;
+    if (typ->flags & TYPE_IS_INTEGER) {
+        if (e == 0)
+            return -1;
+    } else if (e > 2) {
+        return -1;
+    }
+
+    if (e == 0) { /* x^0 == 1, aun con x NaN */
+        seq[k++] = ir_make(INST_drop, lin, col);
+        seq[k]   = ir_make(typ->constpush->code_id, lin, col);
+        seq[k++].cel[1] = typ->one;
+        return k;
+    }
+
+    while (e >> (top + 1))
+        top++;
+
+    int copies = 0;
+    for (int b = 0; b < top; b++) {
+        if (e & (1L << b)) {  /* guarda x^(2^b) */
+            seq[k++] = ir_make(INST_dupl, lin, col);
+            copies++;
+        }
+        seq[k++] = ir_make(INST_dupl, lin, col);
+        seq[k++] = ir_make(typ->mul->code_id, lin, col);
+    }
+    while (copies-- > 0)
+        seq[k++] = ir_make(typ->mul->code_id, lin, col);
+
+    return k;
+} /* pwr_chain */
+
+/* sustitucion de "constpush k; divi/mod" */
+static int div_const(
+        const type2inst *typ,
+        bool             is_mod,
+        long             k,
+        const ir_node   *at,
+        ir_node         *seq)
+{
+    if (typ->divk == NULL || k == 0)
+        return -1;
+
+    int n = 0;
+    if (k > 0 && (k & (k - 1)) == 0) {
+        while ((1L << n) != k)
+            n++;
+        seq[0] = ir_make(is_mod ? typ->modp2->code_id
+                                : typ->divp2->code_id,
+                         at->lin, at->col);
+        if (is_mod)
+            k--;
+        else
+            k = n;
+    } else {
+        seq[0] = ir_make(is_mod ? typ->modk->code_id
+                                : typ->divk->code_id,
+                         at->lin, at->col);
+    }
+    if (typ == &t2i_i)
+        seq[0].cel[1].itg = k;
+    else
+        seq[0].cel[1].lng = k;
+
+    return 1;
+} /* div_const */
+
+bool ir_pass_strength(ir_func *f)
+{
+    bool *tgt     = ir_jump_targets(f);
+    bool  changed = false;
+
+    for (int j = 0; j + 1 < f->nodes_len; j++) {
+        const ir_node *cst = f->nodes + j,
+                      *op  = cst + 1;
+        int            var = 0;
+
+        /* en "x op= k" el operando x se mete despues de k, y se
+         * intercambian: "constpush k; eval x; swap; op" */
+        if (j + 3 < f->nodes_len
+                && f->nodes[j + 2].op == INST_swap
+                && ir_expr_start(f, tgt, j + 1) == j + 1
+                && !tgt[j + 2] && !tgt[j + 3])
+        {
+            var = 1;
+            op  = cst + 3;
+        }
+
+        const type2inst *typ = ir_result_t2i(op);
+        ir_node          seq[MAX_CHAIN + 1];
+        long             val;
+        int              len = -1;
+
+        /* nadie debe saltar entre la constante y el operador */
+        if (tgt[j + 1] || typ == NULL
+                || !is_op(typ->constpush, cst->op)
+                || !int_value(typ, cst, &val))
+            continue;
+
+        if (var)
+            seq[0] = f->nodes[j + 1];
+        if (is_op(typ->pwr, op->op))
+            len = pwr_chain(typ, val, op, seq + var);
+        else if (is_op(typ->divi, op->op))
+            len = div_const(typ, false, val, op, seq + var);
+        else if (is_op(typ->mod, op->op))
+            len = div_const(typ, true, val, op, seq + var);
+
+        if (len < 0)
+            continue;
+        len += var;
+
+        ir_splice(f, j, 2 + 2 * var, seq, len);
+        changed = true;
+
+        free(tgt);
+        tgt = ir_jump_targets(f);
+        j += len - 1;
+    }
+    free(tgt);
+
+    return changed;
+} /* ir_pass_strength */
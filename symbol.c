@@ -17,6 +17,7 @@
 #include "instr.h"
 #include "scope.h"
 #include "code.h"
+#include "progmem.h"
 
 #include "symbolP.h"
 
@@ -95,15 +96,17 @@ Symbol *register_subr(
                     : "VOID",
             entry - prog);
     Symbol *symb = install(name, type, typref);
-    symb->defn   = entry;
+    symb->defn     = entry;
+    symb->defn_end = NULL;  /* hasta end_register_subr() */
 
     return symb;
 }
 
 /* se llama al terminar la definicion de una funcion
  * (o prodecimiento) */
-void end_register_subr(const Symbol *subr)
+void end_register_subr(Symbol *subr)
 {
+    subr->defn_end = progp; /* [defn, defn_end) es el codigo de subr */
     /* adjust progbase to point to the code starting point */
     progbase = progp;     /* next code starts here */
     SYM("%s(%s);\n", __func__, subr->name);
@@ -121,6 +124,8 @@ Symbol *register_global_var(
         execerror("Variable %s already defined\n", name);
     }
     Symbol *sym = install(name, VAR, typref);
+    if (varbase - 1 < progmem_vars_start)
+        progmem_grow_vars(varbase - 1);
     sym->defn = --varbase;
     SYM("Symbol '%s', type=%s, typref=%s, pos=[%04lx]\n",
         sym->name,
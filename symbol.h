@@ -22,7 +22,7 @@ Symbol *register_subr(
         Cell         *entry);  /* punto de entrada a la funcion */
 
 void end_register_subr(        /* end subroutine definition */
-        const Symbol *subr);   /* the symbol given by register_subr */
+        Symbol       *subr);   /* the symbol given by register_subr */
 
 Symbol *register_global_var(   /* registers a global variable */
         const char   *name,    /* name of the function */
@@ -28,6 +28,7 @@ struct Symbol_s {                         /* Symbol table entry */
         struct {                          /* si el tipo es FUNC, PROC o
                                            * VAR o BLTIN_PROC o BLTIN_FUNC */
             Cell       *defn;             /* donde empieza el codigo de la funcion */
+            Cell       *defn_end;         /* donde termina (lo fija end_register_subr) */
             scope      *main_scope;       /* scope principal */
 
             /* Datos necesarios para la macro DYNARRAY() */
@@ -40,9 +41,14 @@ struct Symbol_s {                         /* Symbol table entry */
                         returns_to_patch_cap; /* capacidad de la lista */
 
             int         size_args;        /* tama;o de los argumentos */
-            int         size_lvars;       /* tama;o de las variables locales */
+            int         size_lvars;       /* tama;o de las variables locales
+                                           * (lo que reserva el preambulo,
+                                           * lo fija ir_optimize()) */
             int         bltin_index;      /* indice del builtin, para los builtins */
             int         ret_val_offset;   /* offset del valor a retornar */
+            int         is_inline;        /* declarada con inline: se
+                                           * expande en las llamadas
+                                           * sin mirar su tama;o */
         };
         struct {                          /* si el tipo es LVAR */
             int         offset;           /* variables locales y argumentos (LVAR),
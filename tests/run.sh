@@ -0,0 +1,54 @@
+#!/bin/sh
+# run.sh -- ejecuta los scripts tests/*.hoc con cada juego de
+# pasadas de optimizacion y compara su salida con tests/*.ok
+#
+# Variables de entorno:
+#   HOC      interprete a probar (./hoc)
+#   PLUGINS  plugins a cargar (./plugin0.so)
+#   TESTS    scripts a ejecutar (tests/*.hoc)
+#   OPTS     opciones -O con las que se ejecuta cada uno
+#
+# La salida de error se reduce al mensaje de execerror() (sin la
+# traza de las ultimas instrucciones, que depende del codigo
+# generado), de forma que el .ok vale para todas las opciones:
+# optimizar no puede cambiar lo que hace el programa.
+
+HOC=${HOC:-./hoc}
+PLUGINS=${PLUGINS:-./plugin0.so}
+TESTS=${TESTS:-$(echo tests/*.hoc)}
+OPTS=${OPTS:-"all none dce inline licm cse strength"}
+
+tmp=$(mktemp -d "${TMPDIR:-/tmp}/hoctest.XXXXXX") || exit 1
+trap 'rm -rf "$tmp"' 0 1 2 3 15
+
+# como en bench/bench.sh, plugins y manifiesto propios
+mkdir "$tmp/plugins"
+for p in $PLUGINS; do
+    ln -s "$(cd "$(dirname "$p")" && pwd)/$(basename "$p")" "$tmp/plugins/"
+done
+HOC_PLUGINS_PATH=$tmp/plugins
+HOC_PLUGINS_CACHE=$tmp/plugins.manifest
+export HOC_PLUGINS_PATH HOC_PLUGINS_CACHE
+
+esc=$(printf '\033')
+failed=0
+
+for t in $TESTS; do
+    for o in $OPTS; do
+        "$HOC" -O "$o" "$t" 2>&1 </dev/null \
+            | sed -e "s/${esc}\[[0-9;]*m//g" \
+                  -e "s/^.*hoc: /hoc: /" \
+                  -e "/^last [0-9]* instructions executed:/d" \
+                  -e "/^  sp=/d" \
+                  -e "/^$/d" > "$tmp/out"
+        if cmp -s "${t%.hoc}.ok" "$tmp/out"; then
+            echo "$t -O $o: ok"
+        else
+            echo "$t -O $o: FAILED"
+            diff "${t%.hoc}.ok" "$tmp/out"
+            failed=$((failed + 1))
+        fi
+    done
+done
+
+[ "$failed" -eq 0 ] || { echo "$failed failed"; exit 1; }
@@ -0,0 +1,141 @@
+/* trace.c -- traza binaria de la ejecucion, activable en tiempo
+ * de ejecucion (opcion -t).
+ * License: BSD
+ *
+ * La traza no usa las macros EXEC/P_TAIL de code.c (que solo
+ * existen si se compila con UQ_CODE_DEBUG_EXEC), sino que
+ * instala trace_exec() como envoltorio de todas las
+ * instrucciones (ver set_instruction_wrapper() en instr.h).
+ * Si no se pide la traza, la tabla de despacho es la normal y
+ * no hay coste alguno. */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+
+#include "cellP.h"
+#include "symbolP.h"
+#include "code.h"
+#include "instr.h"
+#include "trace.h"
+
+#ifndef   DEFAULT_HOC_TRACE_FILE /* { */
+#warning  DEFAULT_HOC_TRACE_FILE should be defined in config.mk
+#define   DEFAULT_HOC_TRACE_FILE "hoc.trace"
+#endif /* DEFAULT_HOC_TRACE_FILE    } */
+
+#ifndef   UQ_TRACE_BUFSIZE /* { */
+#warning  UQ_TRACE_BUFSIZE should be defined in config.mk
+#define   UQ_TRACE_BUFSIZE      (65536)
+#endif /* UQ_TRACE_BUFSIZE    } */
+
+static FILE          *trace_out;
+static unsigned long  trace_count;       /* instrucciones ejecutadas */
+static unsigned long  trace_after;       /* after=N */
+static long           trace_lo,          /* addr=LO-HI */
+                      trace_hi = LONG_MAX;
+static char          *trace_func;        /* func=NOMBRE */
+static const Cell    *func_lo, *func_hi; /* su codigo, al resolverlo */
+
+static void trace_exec(const instr *i)
+{
+    const instr *real = instruction_impl + i->code_id;
+    long         addr = pc - prog;
+
+    trace_count++;
+
+    /* la funcion se resuelve en su primera llamada, pues puede
+     * no estar definida cuando se activa la traza */
+    if (trace_func && func_lo == NULL
+            && i->code_id == INST_call
+            && strcmp(pc[1].sym->name, trace_func) == 0) {
+        func_lo = pc[1].sym->defn;
+        func_hi = pc[1].sym->defn_end;
+    }
+
+    if (trace_count > trace_after
+            && addr >= trace_lo && addr < trace_hi
+            && (trace_func == NULL || (pc >= func_lo && pc < func_hi)))
+    {
+        long depth = stacksize();
+        struct trace_rec rec = {
+            .n     = trace_count,
+            .pc    = addr,
+            .op    = i->code_id,
+            .depth = depth > UINT16_MAX ? UINT16_MAX : depth,
+        };
+        fwrite(&rec, sizeof rec, 1, trace_out);
+    }
+
+    real->exec(real);
+} /* trace_exec */
+
+static void trace_close(void)
+{
+    set_instruction_wrapper(NULL);
+    fclose(trace_out);
+} /* trace_close */
+
+static void bad_spec(const char *item)
+{
+    fprintf(stderr, "-t: invalid trace condition '%s'\n", item);
+    exit(EXIT_FAILURE);
+} /* bad_spec */
+
+void trace_init(const char *spec)
+{
+    char       *copy = strdup(spec),
+               *end;
+    const char *file = DEFAULT_HOC_TRACE_FILE;
+
+    for (   char *item = strtok(copy, ",");
+            item != NULL;
+            item = strtok(NULL, ","))
+    {
+        char *val = strchr(item, '=');
+        if (val == NULL)
+            bad_spec(item);
+        *val++ = '\0';
+
+        if (strcmp(item, "func") == 0) {
+            trace_func = strdup(val);
+        } else if (strcmp(item, "addr") == 0) {
+            trace_lo = strtol(val, &end, 16);
+            if (*end != '-')
+                bad_spec(val);
+            trace_hi = strtol(end + 1, &end, 16);
+            if (*end != '\0')
+                bad_spec(val);
+        } else if (strcmp(item, "after") == 0) {
+            trace_after = strtoul(val, &end, 10);
+            if (*end != '\0')
+                bad_spec(val);
+        } else if (strcmp(item, "file") == 0) {
+            file = strdup(val);
+        } else {
+            bad_spec(item);
+        }
+    }
+    free(copy);
+
+    trace_out = fopen(file, "wb");
+    if (trace_out == NULL) {
+        fprintf(stderr, "%s: %s\n", file, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    setvbuf(trace_out, NULL, _IOFBF, UQ_TRACE_BUFSIZE);
+
+    struct trace_header hdr = {
+        .magic    = TRACE_MAGIC,
+        .version  = TRACE_VERSION,
+        .rec_size = sizeof(struct trace_rec),
+    };
+    fwrite(&hdr, sizeof hdr, 1, trace_out);
+
+    set_instruction_wrapper(trace_exec);
+    atexit(trace_close);
+} /* trace_init */
@@ -0,0 +1,40 @@
+/* trace.h -- traza binaria de la ejecucion, activable en tiempo
+ * de ejecucion (opcion -t).
+ * License: BSD
+ */
+#ifndef TRACE_H_5b9f3c06_cba1_11f0_bc4e_0023ae68f329
+#define TRACE_H_5b9f3c06_cba1_11f0_bc4e_0023ae68f329
+
+#include <stdint.h>
+
+/* El fichero de traza empieza con una cabecera trace_header
+ * seguida de registros trace_rec, todos en el orden de bytes
+ * de la maquina que los escribe.  Los codigos de instruccion
+ * son los que muestra la sentencia list (<xx>). */
+
+#define TRACE_MAGIC   "HOCTRACE"
+#define TRACE_VERSION 1
+
+struct trace_header {
+    char     magic[8];   /* TRACE_MAGIC */
+    uint32_t version;    /* TRACE_VERSION */
+    uint32_t rec_size;   /* sizeof(struct trace_rec) */
+};
+
+struct trace_rec {
+    uint64_t n;          /* numero de orden de la instruccion */
+    uint32_t pc;         /* direccion en prog[] */
+    uint16_t op;         /* codigo de la instruccion */
+    uint16_t depth;      /* celdas en la pila (hasta 65535) */
+};
+
+/* activa la traza segun spec, una lista separada por comas de:
+ *   func=NOMBRE  solo las instrucciones de la funcion NOMBRE
+ *   addr=LO-HI   solo las direcciones (hex) en [LO, HI)
+ *   after=N      solo a partir de la instruccion N
+ *   file=PATH    fichero de salida (por defecto
+ *                DEFAULT_HOC_TRACE_FILE)
+ * Las condiciones se combinan (todas deben cumplirse). */
+void trace_init(const char *spec);
+
+#endif /* TRACE_H_5b9f3c06_cba1_11f0_bc4e_0023ae68f329 */
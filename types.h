@@ -71,7 +71,9 @@ struct type2inst_s {
         *const eq,        *const ne,        *const argeval,
         *const argassign, *const prexpr,    *const bit_not,
         *const bit_or,    *const bit_xor,   *const bit_and,
-        *const bit_shl,   *const bit_shr;
+        *const bit_shl,   *const bit_shr,   *const divk,
+        *const modk,      *const divp2,     *const modp2,
+        *const loop_inc_goto, *const argloop_inc_goto;
 
     const Cell        one,
                       zero;